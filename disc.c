@@ -0,0 +1,56 @@
+#include "disc.h"						//we use the discipline loop
+
+//global variables
+static DISC_TypeDef _disc;				//loop state
+static uint32_t _tps;					//engine ticks per second
+static uint16_t _lat;					//stamp latency, ticks
+static int32_t _ppt;					//ppb per tick of frequency error
+static int32_t _fi;						//sum of phase errors - the loop's frequency memory
+static int32_t _frac;					//fractional ticks carried into the next correction, 1/256 tick
+#if MCU_MINI
+RAM_CHK(_disc_ram_chk, sizeof(_disc) + sizeof(_tps) + sizeof(_lat) + sizeof(_ppt) + sizeof(_fi) + sizeof(_frac), MINI_RAM_DISC);
+#endif
+
+//reset the loop
+void disc_init(uint32_t tps, uint16_t lat) {
+	_tps = tps;
+	_lat = lat;
+	_ppt = 1000000000ul / tps;				//1 tick per second in ppb. once, at start up
+	_fi = _frac = 0;
+	_disc.phase = _disc.ppb = _disc.corr = 0;
+	_disc.refs = _disc.steps = 0;
+}
+
+//feed one reference edge
+int32_t disc_ref(uint32_t tick) {
+	int32_t e, c;
+
+	//phase error, wrapped to +/- half a second
+	e = (int32_t) tick - _lat;
+	if (e >= (int32_t) (_tps >> 1)) e -= _tps;
+	else if (e < -(int32_t) (_tps >> 1)) e += _tps;
+	_disc.phase = e;
+	_disc.refs += 1;
+
+	if ((e > DISC_STEP) || (e < -DISC_STEP)) {
+		//far off: step the phase, keep the frequency memory
+		c = e;
+		_frac = 0;
+		_disc.steps += 1;
+	} else {
+		//pi loop, with the fraction carried over so sub-tick corrections average out
+		_fi += e;
+		_frac += (e * 256) >> DISC_KP_SH;
+		_frac += (_fi * 256) >> DISC_KI_SH;
+		c = _frac >> 8;						//whole ticks, rounded down
+		_frac -= c * 256;
+	}
+	_disc.corr = c;
+	_disc.ppb = (((_fi * 256) >> DISC_KI_SH) * _ppt) >> 8;	//frequency term, in ppb
+	return c;
+}
+
+//copy the loop state
+void disc_read(DISC_TypeDef *dst) {
+	*dst = _disc;							//only written by disc_ref() in the main loop
+}
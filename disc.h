@@ -0,0 +1,35 @@
+#ifndef _DISC_H
+#define _DISC_H
+//header file for the discipline loop
+//steers the local 1pps onto a reference pps: a phase step for large errors, then a pi loop
+//all times in ticks of the 1pps engine's counter. runs in the main loop, once per reference edge
+
+#include "gpio.h"
+
+//hardware configuration
+#define DISC_KP_SH			2				//phase gain: 1/2^n of the phase error is corrected per second
+#define DISC_KI_SH			6				//frequency gain: 1/2^n of the summed phase error is corrected per second
+#define DISC_STEP			64				//phase errors beyond +/- this many ticks are stepped out at once
+//end hardware configuration
+
+//loop state, for telemetry
+typedef struct {
+	int32_t phase;							//last phase error: reference edge - local edge - latency. +: local edge early
+	int32_t ppb;							//frequency offset of the local timebase as tracked by the loop. +: local fast
+	int32_t corr;							//last correction handed to the engine. +: next local second stretched
+	uint16_t refs;							//reference edges since disc_init()
+	uint16_t steps;							//phase steps since disc_init()
+} DISC_TypeDef;
+
+//reset the loop
+//tps: engine ticks per second. lat: stamp latency, in ticks
+void disc_init(uint32_t tps, uint16_t lat);
+
+//feed one reference edge, stamped tick ticks after the local edge (0..tps-1)
+//returns the correction for the next local second, in ticks: +: stretch, -: shrink
+int32_t disc_ref(uint32_t tick);
+
+//copy the loop state
+void disc_read(DISC_TypeDef *dst);
+
+#endif
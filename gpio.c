@@ -1,6 +1,13 @@
 #include "gpio.h"
 
 //reset the mcu
+//every peripheral starts powered down: each driver's init routine powers up the block it uses
+//(tmr0_init: timer0, tmr1_init: timer1, ref_init: the analog comparator), so what stays gated follows the build
+//the brown-out detector is set by the BODLEVEL fuses: its software disable (BODS) only applies in sleep
+//modes, which the 1pps engine does not use. battery / solar units should program BODLEVEL to disabled
 void mcu_init(void) {						//reset the mcu
+	ADCSRA &=~(1<<ADEN);					//adc off - it must be off before it is gated, or it stays active
+	ACSR |= (1<<ACD);						//analog comparator off. ACIE is clear after reset, so no spurious isr
+	PRR = MCU_PRR_ALL;						//clocks to all gated peripherals: off
 }
 
@@ -31,6 +31,27 @@
 #define GIO_IN(port, bits)	IO_IN(port->DDR, bits)		//set bits as input
 #define GIO_OUT(port, bits)	IO_OUT(port->DDR, bits)		//ddr |= (bits)		//set bits as output
 
+//atomic pin definitions
+//a pin is a (port, bit) pair - bit is the bit number 0..7, not a mask
+//PIN_SET/PIN_CLR compile to a single sbi/cbi (2 cycles, cannot be torn by an isr)
+//sbi/cbi reach io addresses 0x00..0x1f only. the "I" constraint takes 0..63 and would leave a port past 0x1f to the
+//assembler: the static assertion stops it at compile time, as it does a bit past 7. gcc also refuses a non-constant bit
+#if defined(__GNUC__)
+#define _PIN_CHK(port, bit)	_Static_assert((_SFR_IO_ADDR(port) < 0x20) && ((bit) < 8), "PIN_SET/PIN_CLR: port outside the sbi/cbi range (io 0x00..0x1f), or bit > 7")
+#define PIN_SET(port, bit)	do {_PIN_CHK(port, bit); asm volatile ("sbi %0, %1" : : "I" (_SFR_IO_ADDR(port)), "I" (bit));} while (0)
+#define PIN_CLR(port, bit)	do {_PIN_CHK(port, bit); asm volatile ("cbi %0, %1" : : "I" (_SFR_IO_ADDR(port)), "I" (bit));} while (0)
+#else
+#define PIN_SET(port, bit)	IO_SET(port, 1<<(bit))		//iar emits sbi for a constant single bit
+#define PIN_CLR(port, bit)	IO_CLR(port, 1<<(bit))		//iar emits cbi for a constant single bit
+#endif
+//pin groups: writing 1s to PINx flips the matching PORTx bits - a single out, no read-modify-write
+#define PIN_FLP(pin, bits)	pin = (bits)				//flip bits via the PINx register
+
+//compile-time helpers for pin masks
+#define IO_MULTI(bits)		(((bits) & ((bits) - 1)) != 0)	//1 if more than one bit is set
+#define IO_BIT(bits)		(((bits) & 0x01) ? 0 : ((bits) & 0x02) ? 1 : ((bits) & 0x04) ? 2 : ((bits) & 0x08) ? 3 : \
+							 ((bits) & 0x10) ? 4 : ((bits) & 0x20) ? 5 : ((bits) & 0x40) ? 6 : 7)	//bit number of a single bit mask
+
 #define NOP()				asm("nop")			//nop
 #define NOP2()				{NOP(); NOP();}
 #define NOP4()				{NOP2(); NOP2();}
@@ -57,49 +78,107 @@
 	#define F_CPU			1000000ul			//cpu runs at 1Mhz
 #endif
 
+//minimal footprint build, for the attiny25 (2KB flash, 128B sram). set it on every file: -DMCU_MINI=1
+//isrs call handlers named at build time instead of through run-time pointers, unused channels compile out,
+//telemetry keeps only the slots in TELEM_MASK, and each module's static ram is checked against its budget below
+//build with -Os -flto -ffunction-sections -fdata-sections -Wl,--gc-sections: lto inlines the small driver
+//routines into their callers across files, section gc drops what is left unreferenced
+#ifndef MCU_MINI
+	#define MCU_MINI		0					//1: minimal footprint build
+#endif
+//the 1pps engine's timer and prescaler (see main.c). telem.c and refin.c sample its counter, so every file needs
+//the same setting: give it on the command line for every file, e.g. -DPPS_TIMER=1 -DPS_TMR=64
+#ifndef PPS_TIMER
+	#define PPS_TIMER		0					//0: timer0. 1: 16-bit timer1 (atmega328p, attiny24/44/84)
+#endif
+#ifndef PS_TMR
+	#define PS_TMR			8					//1/8/64/256/1024: clock divider setting for the 1pps timer
+#endif
+//static ram budgets in bytes, MCU_MINI only. what is left of the 128B is stack (isr + main loop): footprint.sh
+//checks the emulated stack high water against it
+#define MINI_RAM_TELEM		40					//telem.c
+#define MINI_RAM_DISC		36					//disc.c
+#define MINI_RAM_PPS		26					//main.c: isr counter + reference / correction handover
+#define MINI_RAM_DRV		4					//timer / reference drivers
+//fails to compile if bytes exceeds budget
+#define RAM_CHK(name, bytes, budget)	typedef char name[((bytes) <= (budget)) ? 1 : -1]
+
+//power reduction: every peripheral the PRR register can gate
+#if defined(PRTWI)
+#define MCU_PRR_ALL			((1<<PRTWI) | (1<<PRTIM2) | (1<<PRTIM1) | (1<<PRTIM0) | (1<<PRSPI) | (1<<PRUSART0) | (1<<PRADC))	//atmega328p
+#else
+#define MCU_PRR_ALL			((1<<PRTIM1) | (1<<PRTIM0) | (1<<PRUSI) | (1<<PRADC))	//attiny25/45/85, attiny24/44/84
+#endif
+
 //void (*mcu_reset)(void) = 0x0000; 			//jump to 0x0000 -> software reset
 void mcu_init(void);
 
+//shift-add multiplication by a constant - the core has no fast 32-bit multiply
+//k (up to 32 bits, its top digit may land on bit 32) is split into its canonical signed digit (non-adjacent) form k = CSD_P(k) - CSD_N(k)
+//no two adjacent digits are non-zero, so it needs the fewest shift-add/subtract terms of any signed binary form
+//every term not present in k folds away at compile time, leaving only (val << i) adds / subtracts - gcc may still
+//recombine them into a multiply where it judges that cheaper. check the listing
+//the terms are computed in val's unsigned promoted type, (val) + 0u: unsigned int for 8/16-bit operands, unsigned long
+//for 32-bit ones. the product keeps that width and wraps in it, as (val + 0u) * k would - no signed shift overflow.
+//a signed operand gives the two's complement product: assign it to a signed type of the same width. widen val
+//yourself where the product needs more bits, e.g. XMUL((uint32_t) per, TMR_TOP). still a constant expression
+//for a constant val, #if included. val is evaluated once per non-zero digit of k: no side effects
+#define _CSD_H(k)			(((k) + 0ull) >> 1)
+#define _CSD_T(k)			(((k) + 0ull) + _CSD_H(k))
+#define CSD_P(k)			(_CSD_T(k) & (_CSD_H(k) ^ _CSD_T(k)))	//positive digits of k
+#define CSD_N(k)			(_CSD_H(k) & (_CSD_H(k) ^ _CSD_T(k)))	//negative digits of k
+#define _XSH(v, i)			((((v) << ((i) / 3)) << ((i) / 3)) << ((i) - (i) / 3 * 2))	//v << i, up to 32, in steps a 16-bit int can take
+#define _XT(val, k, i)		((((CSD_P(k) >> (i)) & 1) ? _XSH((val) + 0u, i) : 0u) - (((CSD_N(k) >> (i)) & 1) ? _XSH((val) + 0u, i) : 0u))
+#define XMUL(val, k)		(_XT(val, k, 0) + _XT(val, k, 1) + _XT(val, k, 2) + _XT(val, k, 3) + \
+							 _XT(val, k, 4) + _XT(val, k, 5) + _XT(val, k, 6) + _XT(val, k, 7) + \
+							 _XT(val, k, 8) + _XT(val, k, 9) + _XT(val, k, 10) + _XT(val, k, 11) + \
+							 _XT(val, k, 12) + _XT(val, k, 13) + _XT(val, k, 14) + _XT(val, k, 15) + \
+							 _XT(val, k, 16) + _XT(val, k, 17) + _XT(val, k, 18) + _XT(val, k, 19) + \
+							 _XT(val, k, 20) + _XT(val, k, 21) + _XT(val, k, 22) + _XT(val, k, 23) + \
+							 _XT(val, k, 24) + _XT(val, k, 25) + _XT(val, k, 26) + _XT(val, k, 27) + \
+							 _XT(val, k, 28) + _XT(val, k, 29) + _XT(val, k, 30) + _XT(val, k, 31) + \
+							 _XT(val, k, 32))	//multiply val by constant k
+
 //simple multiples
 #define x1(val)				(val)								//multiply val by 1
 #define x2(val)				(((val) << 1))						//multiply val by 2
-#define x3(val)				(x2(val) + (val))					//multiply val by 3
+#define x3(val)				XMUL(val, 3)						//multiply val by 3
 #define x4(val)				(((val) << 2))						//multiply val by 4
-#define x5(val)				(x4(val) + (val))					//multiply val by 5
-#define x6(val)				(x4(val) + x2(val))					//multiply val by 6
-#define x7(val)				(x6(val) + (val))					//multiply val by 7
+#define x5(val)				XMUL(val, 5)						//multiply val by 5
+#define x6(val)				XMUL(val, 6)						//multiply val by 6
+#define x7(val)				XMUL(val, 7)						//multiply val by 7
 #define x8(val)				((val) << 3)						//multiply val by 8
-#define x9(val)				(x8(val) + (val))					//multiply val by 9
+#define x9(val)				XMUL(val, 9)						//multiply val by 9
 
 //multiples of 10s
-#define x10(val)			(x8(val) + x2(val))					//multiply val by 10
-#define x100(val)			(x10(x10(val)))						//multiply val by 100
-#define x1000(val)			(x100(x10(val)))					//multiply val by 1000
+#define x10(val)			XMUL(val, 10)						//multiply val by 10
+#define x100(val)			XMUL(val, 100)						//multiply val by 100
+#define x1000(val)			XMUL(val, 1000)						//multiply val by 1000
 #define x1k(val)			x1000(val)							//multiply val by 1000
-#define x10k(val)			(x100(x100(val)))					//multiply val by 10000
+#define x10k(val)			XMUL(val, 10000)					//multiply val by 10000
 
-#define x20(val)			(x2(x10(val)))
-#define x30(val)			(x3(x10(val)))
-#define x40(val)			(x4(x10(val)))
-#define x50(val)			(x5(x10(val)))
-#define x60(val)			(x6(x10(val)))
-#define x70(val)			(x7(x10(val)))
-#define x80(val)			(x8(x10(val)))
-#define x90(val)			(x9(x10(val)))
+#define x20(val)			XMUL(val, 20)
+#define x30(val)			XMUL(val, 30)
+#define x40(val)			XMUL(val, 40)
+#define x50(val)			XMUL(val, 50)
+#define x60(val)			XMUL(val, 60)
+#define x70(val)			XMUL(val, 70)
+#define x80(val)			XMUL(val, 80)
+#define x90(val)			XMUL(val, 90)
 
 //multiples of 100s
-#define x200(val)			(x2(x100(val)))
-#define x300(val)			(x3(x100(val)))
-#define x400(val)			(x4(x100(val)))
-#define x500(val)			(x5(x100(val)))
-#define x600(val)			(x6(x100(val)))
-#define x700(val)			(x7(x100(val)))
-#define x800(val)			(x8(x100(val)))
-#define x900(val)			(x9(x100(val)))
+#define x200(val)			XMUL(val, 200)
+#define x300(val)			XMUL(val, 300)
+#define x400(val)			XMUL(val, 400)
+#define x500(val)			XMUL(val, 500)
+#define x600(val)			XMUL(val, 600)
+#define x700(val)			XMUL(val, 700)
+#define x800(val)			XMUL(val, 800)
+#define x900(val)			XMUL(val, 900)
 
 //custom definitions
-#define x34(val)			(x30(val) + x4(val))				//multiply val by 34
-#define x97(val)			(x90(val) + x7(val))				//multiply val by 97x
+#define x34(val)			XMUL(val, 34)						//multiply val by 34
+#define x97(val)			XMUL(val, 97)						//multiply val by 97x
 
 //arduino related macros
 //arduino pin functions
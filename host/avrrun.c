@@ -0,0 +1,484 @@
+//avrrun: run a firmware image in the host side avr emulator and report isr cycles and supply current
+//
+//build:	cc -O2 -o avrrun avrrun.c avrsim.c osc.c gps.c trace.c golden.c vcd.c -lm
+//usage:	avrrun [-p attiny85] [-f cpu_hz] [-t seconds] [-b] [-s symbol] [-e pin] [-o model[:seed]] [-g model[:seed]] [-m file]
+//		[-l file] [-L file] [-R file | -V file] [-w file[:from[:to]]] [-i load[:period_us[:body[:jit_us]]]] [-r] firmware.elf|firmware.hex
+//	-p: part (attiny25/45/85)
+//	-f: cpu clock in Hz, after the fuse divider - F_OSC / PS_FUSE. default 2430000 (19.44Mhz / 8)
+//	-t: emulated seconds. default 2
+//	-b: brown-out detector enabled by fuse, for the power model
+//	-s: also profile calls to this function (elf only), e.g. pps_out
+//	-e: time the rising edges of PBn from the flag of the isr driving them, e.g. 2 for PPS_PIN (1<<2)
+//	-o: clock the part from an oscillator model (ideal / xo / tcxo / ocxo, see osc.c) and time the -e edges against
+//	    true seconds: -t is then true time. seed: for the noise, default 1
+//	-g: drive a gps pps (ideal / nav / timing, see gps.c) onto REF_PIN (PB0 = AIN0, with AIN1 held at vcc / 2) and
+//	    time the -e edges against true seconds over the second half of the run. each rising pps edge is also timed
+//	    to the TCNT0 read of the PCINT0 / ANA_COMP isr it raises: the reference stamp latency, REF_LAT in refin.h
+//	    (the same for a TCNT1 stamp, read at the same place)
+//	-m: write what the gps receiver sends (NMEA RMC / ZDA, UBX-TIM-TP with qErr) to file
+//	-l: log every -e edge as "n t" - edge number, true time in seconds - for stabrun
+//	-L: the same as a binary trace (trace.c): picosecond ticks, ~3 bytes an edge, appended a block at a time
+//	-R: record a golden trace of the run (golden.c): every isr entry / reti and pin change, with its cycle, the pins and
+//	    the OCR registers
+//	-V: replay the run against a golden trace and stop at the first event that differs. exit 1 if one does
+//	-w: waveforms for gtkwave (vcd.c): PB0..PB5, TCNT0 / OCR0A, TCNT1 / OCR1A and a line per isr, high while it runs,
+//	    from true time from to to seconds (default: the whole run). picosecond time stamps
+//	-i: a competing isr load (avrsim.c sim_inject), up to 4: uart (a soft uart bit at 9600 baud on TIM1_COMPA), pcint
+//	    (pin changes every 500us +/- 450us), adc (free running, 104us), usi (a byte every 80us), a vector name, or none:
+//	    the jitter report alone, as a baseline.
+//	    body: its cycles, reti included. it takes the cpu by the part's rules - the lowest vector first, no
+//	    nesting - and the -e edges get a jitter report: cycles off a straight line through them, as percentiles
+//	-r: one line, machine readable report instead of the tables (for isrbench.sh)
+//
+//every isr is reported in cpu cycles from acceptance (4 cycle response included) to the end of its reti,
+//with its latency from the flag being raised to acceptance
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "avrsim.h"							//we use the emulator
+#include "osc.h"							//we model the oscillator
+#include "gps.h"							//we model the gps reference
+#include "trace.h"							//we write edge traces
+#include "golden.h"							//we record and replay isr events
+#include "vcd.h"							//we dump waveforms
+
+static SIM_TypeDef sim;						//too big for the stack
+
+//oscillator, and the -e edges in true time: e = t - t_first - n * period, fitted to e = a + b * n
+//the period is the firmware's own: cycles between the first two edges, at the nominal clock
+#define OSC_TAU0			0.1				//oscillator model update interval, seconds
+static OSC_TypeDef osc;
+static const OSC_ParamTypeDef *osc_p;
+static double e_t0, e_per, e_last, e_mn, e_me, e_cnn, e_cne, e_cee;	//running means and co-moments (welford)
+static uint64_t e_c0;
+static uint32_t e_n;
+
+//gps reference, and the -e edges against true seconds once the discipline has had half the run to settle
+#define GPS_PIN				0				//REF_PIN: PB0 (PCINT0 / AIN0)
+static GPS_TypeDef gps;
+static const GPS_ParamTypeDef *gps_p;
+static double g_from, g_sum, g_sq, g_max;
+static uint32_t g_n, g_pulses, g_drop, g_out;
+
+//cycle at true time t, and back
+static double clk_cyc(double t) {return osc_p ? osc_cyc(&osc, t) : t * sim.f_cpu;}
+static double clk_time(uint64_t cyc) {return osc_p ? osc_time(&osc, cyc) : cyc / sim.f_cpu;}
+//first whole cycle at or after true time t
+static uint64_t ev_at(double t) {return (t > 0) ? (uint64_t) ceil(clk_cyc(t)) : 0;}
+
+//edge log, as text and as a trace
+static FILE *lf;
+static TRC_WriterTypeDef lt;
+static uint64_t l_n;
+
+//golden trace
+static GOLD_TypeDef gold;
+
+//waveforms, over a window of true time: 0 off, 1 before it, 2 in it, 3 past it
+//registers by data space address: TCNT0, OCR0A, TCNT1, OCR1A
+static const uint8_t w_reg[4] = {0x52, 0x49, 0x4F, 0x4E};
+static const char *const w_rname[4] = {"TCNT0", "OCR0A", "TCNT1", "OCR1A"};
+static VCD_TypeDef vcd;
+static uint8_t w_on, w_last[5];
+static double w_from, w_to;
+static int w_pin[6], w_r[4], w_isr[SIM_VECS];
+
+//competing isr loads: name, vector, period (us), body (cycles), jitter (us)
+typedef struct {
+	const char *name, *vec;
+	double period;
+	uint32_t body;
+	double jit;
+} LoadTypeDef;
+
+static const LoadTypeDef _load[] = {
+	{"uart", "TIM1_COMPA", 104.17, 45, 0},	//bit timer of a 9600 baud soft uart
+	{"pcint", "PCINT0", 500, 60, 450},		//pin change: a button or an encoder, at random
+	{"adc", "ADC", 104, 40, 0},			//free running conversions at clk/128
+	{"usi", "USI_OVF", 80, 30, 0},			//an spi / twi byte
+};
+
+//cycles of the -e edges, for their jitter under the loads
+static uint64_t *j_cyc;
+static uint32_t j_n, j_len;
+static uint8_t j_on;						//1 with any -i, none included
+
+static int dcmp(const void *a, const void *b) {
+	return (*(const double *) a > *(const double *) b) - (*(const double *) a < *(const double *) b);
+}
+
+//edge jitter: cycles off the least squares line through the edges, from the earliest. p50, p99, p99.9 and max
+static int j_fit(double *q) {
+	double mn = (j_n - 1) / 2.0, mc = 0, snn = 0, snc = 0, b, *r;
+	uint32_t k;
+
+	if (j_n < 3) return 1;
+	for (k = 0; k < j_n; k++) mc += (double) (j_cyc[k] - j_cyc[0]) / j_n;
+	for (k = 0; k < j_n; k++) {
+		snn += (k - mn) * (k - mn);
+		snc += (k - mn) * ((double) (j_cyc[k] - j_cyc[0]) - mc);
+	}
+	b = snc / snn;
+	if (!(r = malloc(j_n * sizeof(*r)))) return 1;
+	for (k = 0; k < j_n; k++) r[k] = (double) (j_cyc[k] - j_cyc[0]) - mc - b * (k - mn);
+	qsort(r, j_n, sizeof(*r), dcmp);
+	q[0] = r[j_n / 2] - r[0];
+	q[1] = r[(uint32_t) (j_n * 0.99)] - r[0];
+	q[2] = r[(uint32_t) (j_n * 0.999)] - r[0];
+	q[3] = r[j_n - 1] - r[0];
+	free(r);
+	return 0;
+}
+
+static void w_stamp(SIM_TypeDef *s) {vcd_time(&vcd, llround(clk_time(s->cyc) * 1e12));}
+
+//every cycle in the window: pins and registers, when any has changed
+static void cyc_cb(SIM_TypeDef *s) {
+	uint8_t i, now[5];
+
+	now[0] = s->lvl;
+	for (i = 0; i < 4; i++) now[i + 1] = s->data[w_reg[i]];
+	if (!memcmp(now, w_last, 5)) return;
+	memcpy(w_last, now, 5);
+	w_stamp(s);
+	for (i = 0; i < 6; i++) vcd_set(&vcd, w_pin[i], (now[0] >> i) & 1);
+	for (i = 0; i < 4; i++) vcd_set(&vcd, w_r[i], now[i + 1]);
+}
+
+//window opens: everything as it stands, the isrs in progress included
+static void w_start(SIM_TypeDef *s) {
+	uint8_t i;
+
+	w_stamp(s);
+	for (i = 1; i < s->part->nvec; i++) vcd_set(&vcd, w_isr[i], 0);
+	for (i = 0; (i < s->nest) && (i < SIM_NEST); i++) vcd_set(&vcd, w_isr[s->nest_vec[i]], 1);
+	memset(w_last, 0, sizeof(w_last));
+	w_last[0] = ~s->lvl;						//forces the first sample
+	cyc_cb(s);
+	s->cyc_cb = cyc_cb;
+	w_on = 2;
+}
+
+static void w_stop(SIM_TypeDef *s) {
+	w_stamp(s);
+	s->cyc_cb = NULL;
+	w_on = 3;
+}
+
+static void isr_cb(SIM_TypeDef *s, uint8_t vec, uint8_t in) {
+	if (gold.fp) gold_sim(&gold, s, in ? GOLD_ENTER : GOLD_RETI, vec);
+	if ((w_on == 2) && (vec < SIM_VECS)) {
+		w_stamp(s);
+		vcd_set(&vcd, w_isr[vec], in);
+	}
+}
+
+//pin edges, for a sanity check of the output
+static uint32_t edges[8];
+static void pin_cb(SIM_TypeDef *s, uint8_t old, uint8_t lvl) {
+	uint8_t i, up = lvl & ~old;
+	double t, e, dn, de;
+
+	for (i = 0; i < 8; i++) if (up & (1 << i)) edges[i] += 1;
+	if (gold.fp) gold_sim(&gold, s, GOLD_PIN, 0);
+	if (j_on && (up & s->edge_pin)) {
+		if (j_n == j_len) j_cyc = realloc(j_cyc, (j_len = j_len ? 2 * j_len : 4096) * sizeof(*j_cyc));
+		if (j_cyc) j_cyc[j_n++] = s->cyc;
+		else j_len = j_n = 0;
+	}
+	if ((lf || lt.fp) && (up & s->edge_pin)) {
+		t = clk_time(s->cyc);
+		if (lf) fprintf(lf, "%llu %.12f\n", (unsigned long long) l_n, t);
+		if (lt.fp) trc_add(&lt, l_n, llround(t * lt.hz));
+		l_n += 1;
+	}
+	if (gps_p && (up & s->edge_pin) && ((t = clk_time(s->cyc)) >= g_from)) {
+		e = t - floor(t + 0.5);
+		g_sum += e; g_sq += e * e;
+		if (fabs(e) > g_max) g_max = fabs(e);
+		g_n += 1;
+	}
+	if (osc_p && (up & s->edge_pin)) {
+		t = osc_time(&osc, s->cyc);
+		if (!e_n) {e_t0 = t; e_c0 = s->cyc;}
+		if (e_n == 1) e_per = (s->cyc - e_c0) / s->f_cpu;
+		e = e_last = t - e_t0 - e_n * e_per;
+		e_n += 1;
+		dn = (e_n - 1) - e_mn; e_mn += dn / e_n;
+		de = e - e_me; e_me += de / e_n;
+		e_cnn += dn * ((e_n - 1) - e_mn); e_cne += dn * (e - e_me); e_cee += de * (e - e_me);
+	}
+}
+
+//fractional frequency offset of the edges, and the rms residual of the fit, seconds
+static void e_fit(double *b, double *rms) {
+	double r;
+
+	*b = *rms = 0;
+	if ((e_n < 3) || (e_cnn == 0) || (e_per == 0)) return;
+	*b = e_cne / e_cnn / e_per;
+	r = e_cee - e_cne * e_cne / e_cnn;
+	*rms = (r > 0) ? sqrt(r / e_n) : 0;
+}
+
+int main(int argc, char **argv) {
+	const SIM_PartTypeDef *part = &sim_tiny85;
+	double f_cpu = 2430000.0, secs = 2, tot = 0, saved = 0;
+	const char *path = NULL, *fn = NULL;
+	char model[16] = "";
+	const char *msgs = NULL, *log = NULL, *trace = NULL, *golden = NULL;
+	uint8_t record = 0;
+	const char *ld[SIM_LOADS];
+	uint8_t nld = 0, v;
+	double jq[4];
+	char ev_s[128], wave[256] = "";
+	FILE *mf = NULL;
+	GPS_PulseTypeDef p;
+	uint64_t lim, ev = 0, c;
+	uint8_t hi = 0, last;
+	uint8_t bod = 0, raw = 0, i;
+	int a, pin = -1;
+	int32_t addr;
+	unsigned long long seed = 1, gseed = 1;
+	double b, rms, t;
+
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-p") && (a + 1 < argc)) part = sim_part(argv[++a]);
+		else if (!strcmp(argv[a], "-f") && (a + 1 < argc)) f_cpu = atof(argv[++a]);
+		else if (!strcmp(argv[a], "-t") && (a + 1 < argc)) secs = atof(argv[++a]);
+		else if (!strcmp(argv[a], "-b")) bod = 1;
+		else if (!strcmp(argv[a], "-s") && (a + 1 < argc)) fn = argv[++a];
+		else if (!strcmp(argv[a], "-e") && (a + 1 < argc)) pin = atoi(argv[++a]);
+		else if (!strcmp(argv[a], "-o") && (a + 1 < argc)) {
+			sscanf(argv[++a], "%15[^:]:%llu", model, &seed);
+			if (!(osc_p = osc_param(model))) f_cpu = 0;
+		}
+		else if (!strcmp(argv[a], "-g") && (a + 1 < argc)) {
+			sscanf(argv[++a], "%15[^:]:%llu", model, &gseed);
+			if (!(gps_p = gps_param(model))) f_cpu = 0;
+		}
+		else if (!strcmp(argv[a], "-m") && (a + 1 < argc)) msgs = argv[++a];
+		else if (!strcmp(argv[a], "-l") && (a + 1 < argc)) log = argv[++a];
+		else if (!strcmp(argv[a], "-L") && (a + 1 < argc)) trace = argv[++a];
+		else if (!strcmp(argv[a], "-R") && (a + 1 < argc)) {golden = argv[++a]; record = 1;}
+		else if (!strcmp(argv[a], "-V") && (a + 1 < argc)) {golden = argv[++a]; record = 0;}
+		else if (!strcmp(argv[a], "-w") && (a + 1 < argc)) {
+			w_to = -1;
+			sscanf(argv[++a], "%255[^:]:%lf:%lf", wave, &w_from, &w_to);
+		}
+		else if (!strcmp(argv[a], "-i") && (a + 1 < argc)) {
+			if (nld < SIM_LOADS) ld[nld++] = argv[++a];
+			else f_cpu = 0;
+		}
+		else if (!strcmp(argv[a], "-r")) raw = 1;
+		else path = argv[a];
+	}
+	if (!part || !path || (f_cpu <= 0)) {
+		fprintf(stderr, "usage: avrrun [-p attiny85] [-f cpu_hz] [-t seconds] [-b] [-s symbol] [-e pin] [-o model[:seed]] [-g model[:seed]] [-m file] [-l file] [-L file] [-R file | -V file] [-w file[:from[:to]]] [-i load[:period_us[:body[:jit_us]]]] [-r] firmware.elf|firmware.hex\n");
+		return 2;
+	}
+	sim_init(&sim, part, f_cpu);
+	sim.bod = bod;
+	sim.pin_cb = pin_cb;
+	if (sim_load(&sim, path)) {
+		fprintf(stderr, "avrrun: cannot load %s\n", path);
+		return 2;
+	}
+	if (fn) {
+		if ((addr = sim_sym(&sim, fn)) < 0) {
+			fprintf(stderr, "avrrun: no symbol %s\n", fn);
+			return 2;
+		}
+		sim_prof(&sim, addr);
+	}
+	if ((pin >= 0) && (pin < 8)) sim.edge_pin = 1 << pin;
+	for (a = 0; a < nld; a++) {				//loads: a preset, or a vector, with the preset's figures overridden
+		LoadTypeDef l = {NULL, NULL, 100, 40, 0};
+		char name[16] = "";
+
+		sscanf(ld[a], "%15[^:]", name);
+		j_on = 1;
+		if (!strcmp(name, "none")) continue;
+		for (i = 0; i < sizeof(_load) / sizeof(_load[0]); i++) if (!strcmp(name, _load[i].name)) l = _load[i];
+		if (!l.vec) l.vec = name;
+		sscanf(ld[a], "%*[^:]:%lf:%u:%lf", &l.period, &l.body, &l.jit);
+		for (v = 1; (v < part->nvec) && strcmp(l.vec, part->vec[v]); v++);
+		if ((v == part->nvec) || sim_inject(&sim, v, l.period * 1e-6 * f_cpu, l.jit * 1e-6 * f_cpu, l.body, seed + a)) {
+			fprintf(stderr, "avrrun: bad load %s\n", ld[a]);
+			return 2;
+		}
+	}
+	if ((msgs && !(mf = fopen(msgs, "wb"))) || (log && !(lf = fopen(log, "w")))) {
+		fprintf(stderr, "avrrun: cannot write %s\n", (msgs && !mf) ? msgs : log);
+		return 2;
+	}
+	if (trace && trc_create(&lt, trace, 0)) {
+		fprintf(stderr, "avrrun: cannot write %s\n", trace);
+		return 2;
+	}
+	if (golden) {
+		if (gold_open(&gold, golden, record)) {
+			fprintf(stderr, "avrrun: cannot %s %s\n", record ? "write" : "read the golden trace", golden);
+			return 2;
+		}
+		sim.isr_cb = isr_cb;
+	}
+	if (*wave) {
+		if (vcd_open(&vcd, wave, "1ps", part->name)) {
+			fprintf(stderr, "avrrun: cannot write %s\n", wave);
+			return 2;
+		}
+		for (i = 0; i < 6; i++) {
+			snprintf(ev_s, sizeof(ev_s), "PB%u", i);
+			w_pin[i] = vcd_var(&vcd, ev_s, 1);
+		}
+		for (i = 0; i < 4; i++) w_r[i] = vcd_var(&vcd, w_rname[i], 8);
+		for (i = 1; i < part->nvec; i++) w_isr[i] = vcd_var(&vcd, part->vec[i], 1);
+		if (w_to < 0) w_to = secs;
+		w_on = 1;
+		sim.isr_cb = isr_cb;
+	}
+	if (osc_p) osc_init(&osc, osc_p, f_cpu, OSC_TAU0, seed);
+	if (gps_p) {
+		gps_init(&gps, gps_p, gseed);
+		g_from = secs / 2;
+		sim_ain(&sim, 1, sim.vcc / 2);		//comparator threshold, for REF_ACOMP
+		sim.stamp_pin = 1 << GPS_PIN;
+		sim.stamp_reg = 0x52;				//TCNT0, data address
+		for (i = 0; i < part->nvec; i++)	//REF_PCINT, REF_ACOMP
+			if (!strcmp(part->vec[i], "PCINT0") || !strcmp(part->vec[i], "ANA_COMP")) sim.stamp_vecs |= 1ul << i;
+		gps_next(&gps, &p);
+		ev = ev_at(p.t);
+	}
+	//run a second of true time at most at a time, so the oscillator model is made just ahead of the emulator,
+	//and stop at each gps pin change: it lands on the first instruction boundary at or after its cycle
+	for (;;) {
+		t = clk_time(sim.cyc);
+		last = (t + 1 >= secs);
+		lim = ev_at(last ? secs : t + 1);
+		if (gps_p && (ev < lim)) {lim = ev; last = 0;}
+		c = UINT64_MAX;							//waveform window: where it opens or closes, if in this step
+		if ((w_on == 1) && (w_from < t + 1)) c = ev_at(w_from);
+		if ((w_on == 2) && (w_to < t + 1)) c = ev_at(w_to);
+		if (c < lim) {lim = c; last = 0;}
+		sim_run(&sim, lim);
+		if ((w_on == 1) && (sim.cyc >= c)) w_start(&sim);
+		else if ((w_on == 2) && (sim.cyc >= c)) w_stop(&sim);
+		if (sim.stop || last || gold.diverged) break;
+		if (!gps_p || (sim.cyc < ev)) continue;
+		if (!hi) {
+			hi = 1;
+			if (p.ok) sim_drive(&sim, GPS_PIN, 1);		//a dropped pulse leaves the pin low
+			ev = ev_at(p.t + gps_p->width);
+			continue;
+		}
+		hi = 0;
+		sim_drive(&sim, GPS_PIN, 0);
+		g_pulses += p.ok; g_drop += !p.ok; g_out += p.outlier;
+		if (mf) fwrite(gps.msg, 1, gps.msg_len, mf);
+		gps_next(&gps, &p);
+		ev = ev_at(p.t);
+	}
+	if (mf) fclose(mf);
+	if (lf) fclose(lf);
+	if (lt.fp && trc_close(&lt)) fprintf(stderr, "avrrun: error writing %s\n", trace);
+	if (w_on == 2) w_stop(&sim);
+	if (w_on && vcd_close(&vcd)) fprintf(stderr, "avrrun: error writing %s\n", wave);
+	if (golden && gold_close(&gold) && record) fprintf(stderr, "avrrun: error writing %s\n", golden);
+	e_fit(&b, &rms);
+	if (sim.stop) fprintf(stderr, "avrrun: stopped at 0x%04x (%s) after %llu cycles\n", sim.stop_pc * 2,
+		(sim.stop == SIM_BREAK) ? "break" : (sim.stop == SIM_ILLEGAL) ? "illegal opcode" : "asleep with interrupts off",
+		(unsigned long long) sim.cyc);
+
+	if (raw) {
+		//isr:<name>:<runs>:<min>:<avg>:<max>:<lat_max>:<load%> ... fn:<name>:<runs>:<min>:<avg>:<max> edge:<runs>:<lat_min>:<lat_max>
+		for (i = 0; i < part->nvec; i++) {
+			SIM_IsrTypeDef *st = &sim.isr[i];
+			if (!st->n) continue;
+			printf("isr:%s:%lu:%lu:%.1f:%lu:%lu:%.3f ", part->vec[i], (unsigned long) st->n, (unsigned long) st->min,
+				(double) st->sum / st->n, (unsigned long) st->max, (unsigned long) st->lat_max, 100.0 * st->sum / sim.cyc);
+		}
+		if (fn) printf("fn:%s:%lu:%lu:%.1f:%lu ", fn, (unsigned long) sim.fn.n, sim.fn.n ? (unsigned long) sim.fn.min : 0,
+			sim.fn.n ? (double) sim.fn.sum / sim.fn.n : 0, (unsigned long) sim.fn.max);
+		if (sim.edge_pin) printf("edge:%lu:%lu:%lu ", (unsigned long) sim.edge.n, sim.edge.n ? (unsigned long) sim.edge.lat_min : 0,
+			(unsigned long) sim.edge.lat_max);
+		//stack:<main loop bytes>:<isr bytes>, the deepest each went
+		printf("stack:%u:%u ", sim.stk_main, sim.stk_isr);
+		//ref:<stamps>:<lat_min>:<avg>:<lat_max>, cycles from the pps edge to the TCNT0 read
+		if (sim.stamp.n) printf("ref:%lu:%lu:%.1f:%lu ", (unsigned long) sim.stamp.n, (unsigned long) sim.stamp.lat_min,
+			(double) sim.stamp.sum / sim.stamp.n, (unsigned long) sim.stamp.lat_max);
+		//load:<vector>:<requests>:<lost> ... jit:<edges>:<p50>:<p99>:<p99.9>:<max>, cycles off a straight line
+		for (a = 0; a < sim.nload; a++) printf("load:%s:%lu:%lu ", part->vec[sim.load[a].vec],
+			(unsigned long) sim.load[a].req, (unsigned long) sim.load[a].lost);
+		if (j_on && !j_fit(jq)) printf("jit:%lu:%.1f:%.1f:%.1f:%.1f ", (unsigned long) j_n, jq[0], jq[1], jq[2], jq[3]);
+		//osc:<model>:<edges>:<time error of the last edge, ns>:<fractional frequency offset, ppb>:<rms residual, ns>
+		if (osc_p && sim.edge_pin) printf("osc:%s:%lu:%.3f:%.3f:%.3f ", osc_p->name, (unsigned long) e_n, e_last * 1e9, b * 1e9, rms * 1e9);
+		//gps:<model>:<pulses>:<dropped>:<outliers>:<edges timed>:<mean error, ns>:<rms error, ns>:<max |error|, ns>
+		if (gps_p && sim.edge_pin) printf("gps:%s:%lu:%lu:%lu:%lu:%.3f:%.3f:%.3f", gps_p->name, (unsigned long) g_pulses,
+			(unsigned long) g_drop, (unsigned long) g_out, (unsigned long) g_n, g_n ? g_sum / g_n * 1e9 : 0,
+			g_n ? sqrt(g_sq / g_n) * 1e9 : 0, g_max * 1e9);
+		//gold:<events>:<0 as golden, 1 differs, 2 golden ended first, 3 this run did>:<cycle of the first difference>
+		if (golden && !record) printf("gold:%llu:%u:%llu", (unsigned long long) gold.n, gold.diverged,
+			(unsigned long long) (gold.diverged ? (gold.diverged == 3) ? gold.want.cyc : gold.got.cyc : 0));
+		printf("\n");
+		sim_free(&sim);
+		return (sim.stop || (golden && !record && gold.diverged)) ? 1 : 0;
+	}
+
+	printf("%s @ %.0fHz, %.3fs (%llu cycles)\n\n", part->name, f_cpu, sim.cyc / f_cpu, (unsigned long long) sim.cyc);
+	printf("%-12s %10s %6s %8s %6s %8s %8s %7s\n", "isr", "runs", "min", "avg", "max", "lat_min", "lat_max", "load%");
+	for (i = 0; i < part->nvec; i++) {
+		SIM_IsrTypeDef *st = &sim.isr[i];
+		if (!st->n) continue;
+		printf("%-12s %10lu %6lu %8.1f %6lu %8lu %8lu %7.3f\n", part->vec[i], (unsigned long) st->n,
+			(unsigned long) st->min, (double) st->sum / st->n, (unsigned long) st->max,
+			(unsigned long) st->lat_min, (unsigned long) st->lat_max, 100.0 * st->sum / sim.cyc);
+	}
+
+	if (fn) {
+		if (sim.fn.n) printf("%-12s %10lu %6lu %8.1f %6lu\n", fn, (unsigned long) sim.fn.n, (unsigned long) sim.fn.min,
+			(double) sim.fn.sum / sim.fn.n, (unsigned long) sim.fn.max);
+		else printf("%-12s never called (inlined?)\n", fn);
+	}
+	if (sim.edge_pin && sim.edge.n) printf("\nPB%d edge latency: %lu..%lu cycles from the compare flag (%lu cycles of jitter)\n", pin,
+		(unsigned long) sim.edge.lat_min, (unsigned long) sim.edge.lat_max, (unsigned long) (sim.edge.lat_max - sim.edge.lat_min));
+	if (osc_p && (e_n > 1)) printf("PB%d in true time (%s oscillator, seed %llu): %lu edges, the last %.1fns off the first + n periods,"
+		" %.3fppb frequency offset, %.1fns rms about it\n", pin, osc_p->name, seed, (unsigned long) e_n,
+		e_last * 1e9, b * 1e9, rms * 1e9);
+	if (gps_p) printf("gps reference (%s, seed %llu): %lu pulses, %lu dropped, %lu outliers\n", gps_p->name, gseed,
+		(unsigned long) g_pulses, (unsigned long) g_drop, (unsigned long) g_out);
+	printf("stack: %u bytes deep in the main loop + %u in an isr, %u of the %u bytes of sram\n", sim.stk_main, sim.stk_isr,
+		sim.stk_main + sim.stk_isr, part->ramend + 1 - part->ramstart);
+	if (sim.stamp.n) printf("reference stamp latency: %lu..%lu cycles, %.1f on average, from the PB%d edge to the TCNT0 read"
+		" (REF_LAT), %lu edges\n", (unsigned long) sim.stamp.lat_min, (unsigned long) sim.stamp.lat_max,
+		(double) sim.stamp.sum / sim.stamp.n, GPS_PIN, (unsigned long) sim.stamp.n);
+	if (gps_p && g_n) printf("PB%d against true seconds, last %.0fs: %lu edges, %.1fns mean, %.1fns rms, %.1fns worst\n", pin,
+		secs - g_from, (unsigned long) g_n, g_sum / g_n * 1e9, sqrt(g_sq / g_n) * 1e9, g_max * 1e9);
+	for (a = 0; a < sim.nload; a++) printf("load on %s: %lu requests, %lu lost (still pending at the next)\n",
+		part->vec[sim.load[a].vec], (unsigned long) sim.load[a].req, (unsigned long) sim.load[a].lost);
+	if (j_on && sim.edge_pin && !j_fit(jq)) printf("PB%d jitter under load, %lu edges: %.1f p50, %.1f p99, %.1f p99.9, "
+		"%.1f p-p cycles off a straight line\n", pin, (unsigned long) j_n, jq[0], jq[1], jq[2], jq[3]);
+
+	printf("\npin rising edges:");
+	for (i = 0; i < 6; i++) printf(" PB%u=%lu", i, (unsigned long) edges[i]);
+	printf("\n\n%-8s %10s %10s\n", "block", "uA", "saved uA");
+	for (i = 0; i < SIM_P_BLOCKS; i++) {
+		printf("%-8s %10.1f %10.1f\n", sim_pname[i], sim_ua(&sim, i), sim_ua_saved(&sim, i));
+		tot += sim_ua(&sim, i);
+		saved += sim_ua_saved(&sim, i);
+	}
+	printf("%-8s %10.1f %10.1f\n", "total", tot, saved);
+
+	if (golden && record) printf("golden trace: %llu events recorded to %s\n", (unsigned long long) gold.n, golden);
+	else if (golden && !gold.diverged) printf("golden trace: %llu events, all as in %s\n", (unsigned long long) gold.n, golden);
+	else if (golden) {
+		printf("golden trace: event %llu differs from %s\n", (unsigned long long) gold.n, golden);
+		printf("  golden  %s\n", (gold.diverged == 2) ? "(ended)" : gold_str(&gold.want, part->vec, ev_s, sizeof(ev_s)));
+		printf("  this    %s\n", (gold.diverged == 3) ? "(ended)" : gold_str(&gold.got, part->vec, ev_s, sizeof(ev_s)));
+		if (gold.n > 1) printf("  after   %s\n", gold_str(&gold.last, part->vec, ev_s, sizeof(ev_s)));
+	}
+	sim_free(&sim);
+	return (sim.stop || (golden && !record && gold.diverged)) ? 1 : 0;
+}
@@ -0,0 +1,1088 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "avrsim.h"							//we emulate the avr
+
+//attiny25/45/85 io registers, as data space addresses (io + 0x20)
+#define IO_SREG				0x5F
+#define IO_SPH				0x5E
+#define IO_SPL				0x5D
+#define IO_GIMSK			0x5B
+#define IO_GIFR				0x5A
+#define IO_TIMSK			0x59
+#define IO_TIFR				0x58
+#define IO_MCUCR			0x55
+#define IO_TCCR0B			0x53
+#define IO_TCNT0			0x52
+#define IO_TCCR1			0x50
+#define IO_TCNT1			0x4F
+#define IO_OCR1A			0x4E
+#define IO_OCR1C			0x4D
+#define IO_GTCCR			0x4C
+#define IO_OCR1B			0x4B
+#define IO_TCCR0A			0x4A
+#define IO_OCR0A			0x49
+#define IO_OCR0B			0x48
+#define IO_PRR				0x40
+#define IO_PORTB			0x38
+#define IO_DDRB				0x37
+#define IO_PINB				0x36
+#define IO_PCMSK			0x35
+#define IO_ACSR				0x28
+#define IO_ADCSRA			0x26
+
+//SREG bits
+#define F_C					0x01
+#define F_Z					0x02
+#define F_N					0x04
+#define F_V					0x08
+#define F_S					0x10
+#define F_H					0x20
+#define F_T					0x40
+#define F_I					0x80
+
+//pins of the compare outputs
+#define PIN_OC0A			0x01			//PB0
+#define PIN_OC0B			0x02			//PB1
+#define PIN_OC1A			0x02			//PB1
+#define PIN_OC1B			0x10			//PB4
+
+//power model: typical currents at 3v, from the attiny25/45/85 datasheet tables
+//per Mhz figures scale with the cpu clock. rough - good for comparing builds, not for a power budget
+#define SIM_I_ACT			375.0			//uA per Mhz, core active
+#define SIM_I_IDLE			94.0			//uA per Mhz, core idle
+#define SIM_I_TIM0			4.0				//uA per Mhz, timer0 clocked (PRTIM0 clear)
+#define SIM_I_TIM1			75.0			//uA per Mhz, timer1 clocked (PRTIM1 clear)
+#define SIM_I_USI			6.0				//uA per Mhz, usi clocked (PRUSI clear)
+#define SIM_I_ADCD			21.0			//uA per Mhz, adc digital clocked (PRADC clear)
+#define SIM_I_ADCA			230.0			//uA, adc analog enabled (ADEN)
+#define SIM_I_AC			60.0			//uA, analog comparator on (ACD clear - its reset state)
+#define SIM_I_BOD			20.0			//uA, brown-out detector on
+
+//parts
+const SIM_PartTypeDef sim_tiny25 = {"attiny25", 2048, 0x60, 0xDF, 15,
+	{"RESET", "INT0", "PCINT0", "TIM1_COMPA", "TIM1_OVF", "TIM0_OVF", "EE_RDY", "ANA_COMP",
+	 "ADC", "TIM1_COMPB", "TIM0_COMPA", "TIM0_COMPB", "WDT", "USI_START", "USI_OVF"}};
+const SIM_PartTypeDef sim_tiny45 = {"attiny45", 4096, 0x60, 0x15F, 15,
+	{"RESET", "INT0", "PCINT0", "TIM1_COMPA", "TIM1_OVF", "TIM0_OVF", "EE_RDY", "ANA_COMP",
+	 "ADC", "TIM1_COMPB", "TIM0_COMPA", "TIM0_COMPB", "WDT", "USI_START", "USI_OVF"}};
+const SIM_PartTypeDef sim_tiny85 = {"attiny85", 8192, 0x60, 0x25F, 15,
+	{"RESET", "INT0", "PCINT0", "TIM1_COMPA", "TIM1_OVF", "TIM0_OVF", "EE_RDY", "ANA_COMP",
+	 "ADC", "TIM1_COMPB", "TIM0_COMPA", "TIM0_COMPB", "WDT", "USI_START", "USI_OVF"}};
+
+const char *sim_pname[SIM_P_BLOCKS] = {"cpu", "timer0", "timer1", "usi", "adc", "acomp", "bod"};
+
+//interrupt sources, in priority order: vector, flag register / bit, enable register / bit
+//the hardware clears each of these flags when its vector is taken
+static const struct {
+	uint8_t vec, flag, fbit, mask, mbit;
+} _src[] = {
+	{2, IO_GIFR, 5, IO_GIMSK, 5},			//PCINT0
+	{3, IO_TIFR, 6, IO_TIMSK, 6},			//TIM1_COMPA
+	{4, IO_TIFR, 2, IO_TIMSK, 2},			//TIM1_OVF
+	{5, IO_TIFR, 1, IO_TIMSK, 1},			//TIM0_OVF
+	{7, IO_ACSR, 4, IO_ACSR, 3},			//ANA_COMP
+	{9, IO_TIFR, 5, IO_TIMSK, 5},			//TIM1_COMPB
+	{10, IO_TIFR, 4, IO_TIMSK, 4},			//TIM0_COMPA
+	{11, IO_TIFR, 3, IO_TIMSK, 3},			//TIM0_COMPB
+};
+#define NSRC				(sizeof(_src) / sizeof(_src[0]))
+
+//look up a part by name
+const SIM_PartTypeDef *sim_part(const char *name) {
+	if (!strcmp(name, "attiny25") || !strcmp(name, "t25")) return &sim_tiny25;
+	if (!strcmp(name, "attiny45") || !strcmp(name, "t45")) return &sim_tiny45;
+	if (!strcmp(name, "attiny85") || !strcmp(name, "t85")) return &sim_tiny85;
+	return NULL;
+}
+
+//raise an interrupt flag, remembering when for the latency figures
+static void flag_set(SIM_TypeDef *s, uint8_t reg, uint8_t bit) {
+	uint8_t i;
+
+	if (s->data[reg] & (1<<bit)) return;	//already pending: the first edge counts
+	s->data[reg] |= 1<<bit;
+	for (i = 0; i < NSRC; i++)
+		if ((_src[i].flag == reg) && (_src[i].fbit == bit)) s->raised[_src[i].vec] = s->cyc;
+}
+
+//recompute the pin levels, and report changes
+static void pins_update(SIM_TypeDef *s) {
+	uint8_t ddr = s->data[IO_DDRB];
+	uint8_t out = (s->data[IO_PORTB] & ~s->oc_en) | (s->oc & s->oc_en);
+	uint8_t lvl = ((out & ddr) | (s->ext & ~ddr)) & 0x3F;
+	uint8_t old = s->lvl;
+
+	if (lvl == old) return;
+	s->lvl = lvl;
+	if ((lvl & ~old & s->edge_pin) && s->nest && (s->nest <= SIM_NEST)) {
+		uint64_t lat = s->cyc - s->raised[s->nest_vec[s->nest - 1]];
+		s->edge.n += 1;
+		if (lat < s->edge.lat_min) s->edge.lat_min = lat;
+		if (lat > s->edge.lat_max) s->edge.lat_max = lat;
+	}
+	if (s->pin_cb) s->pin_cb(s, old, lvl);
+}
+
+//pins driven by compare outputs: COM bits non-zero
+static void oc_update(SIM_TypeDef *s) {
+	uint8_t en = 0;
+
+	if (s->data[IO_TCCR0A] & 0xC0) en |= PIN_OC0A;
+	if (s->data[IO_TCCR0A] & 0x30) en |= PIN_OC0B;
+	if (s->data[IO_TCCR1] & 0x30) en |= PIN_OC1A;
+	if (s->data[IO_GTCCR] & 0x30) en |= PIN_OC1B;
+	s->oc_en = en;
+	pins_update(s);
+}
+
+//compare output action on a match, non-pwm modes: com 1 = toggle, 2 = clear, 3 = set
+static void oc_act(SIM_TypeDef *s, uint8_t pin, uint8_t com) {
+	switch (com) {
+		case 1: s->oc ^= pin; break;
+		case 2: s->oc &=~pin; break;
+		case 3: s->oc |= pin; break;
+	}
+	pins_update(s);
+}
+
+//data space read
+static uint8_t rd(SIM_TypeDef *s, uint16_t a) {
+	if (a >= SIM_DATA) return 0;
+	if (s->stamp_on && (a == s->stamp_reg) && s->nest && (s->nest <= SIM_NEST) &&
+		(s->stamp_vecs & (1ul << s->nest_vec[s->nest - 1]))) {
+		uint64_t lat = s->cyc - s->stamp_t0;
+		s->stamp_on = 0;
+		s->stamp.n += 1;
+		s->stamp.sum += lat;
+		if (lat < s->stamp.lat_min) s->stamp.lat_min = lat;
+		if (lat > s->stamp.lat_max) s->stamp.lat_max = lat;
+	}
+	switch (a) {
+		case IO_PINB: return s->sync;
+		case IO_ACSR: return (s->data[a] & ~0x20) | (s->aco ? 0x20 : 0);
+	}
+	return s->data[a];
+}
+
+//stack depth high water marks, after the stack pointer moved down
+static void stk_chk(SIM_TypeDef *s) {
+	uint16_t sp = s->data[IO_SPL] | (s->data[IO_SPH] << 8), d;
+
+	if (!s->nest) {
+		d = s->part->ramend - sp;
+		if ((sp <= s->part->ramend) && (d > s->stk_main)) s->stk_main = d;
+	} else {
+		d = s->isr_sp - sp;
+		if ((sp <= s->isr_sp) && (d > s->stk_isr)) s->stk_isr = d;
+	}
+}
+
+//data space write
+static void wr(SIM_TypeDef *s, uint16_t a, uint8_t v) {
+	if (a >= SIM_DATA) return;
+	switch (a) {
+		case IO_TIFR:
+		case IO_GIFR:
+			s->data[a] &=~v;				//flags clear by writing 1
+			return;
+		case IO_ACSR:
+			s->data[a] = (v & ~0x30) | (s->data[a] & 0x10 & ~v);	//ACO read only, ACI clears by writing 1
+			return;
+		case IO_PINB:
+			s->data[IO_PORTB] ^= v;			//writing 1s flips PORTB
+			pins_update(s);
+			return;
+		case IO_PORTB:
+		case IO_DDRB:
+			s->data[a] = v;
+			pins_update(s);
+			return;
+		case IO_TCNT0:
+			s->data[a] = v;
+			s->t0_block = 1;				//a TCNT0 write blocks the compare match on the next timer clock
+			return;
+		case IO_TCNT1:
+			s->data[a] = v;
+			s->t1_block = 1;
+			return;
+		case IO_TCCR0B:
+			if (v & 0x80) oc_act(s, PIN_OC0A, s->data[IO_TCCR0A] >> 6);			//FOC0A: no flag
+			if (v & 0x40) oc_act(s, PIN_OC0B, (s->data[IO_TCCR0A] >> 4) & 3);	//FOC0B
+			s->data[a] = v & 0x0F;
+			return;
+		case IO_GTCCR:
+			if (v & 0x01) s->pre0 = 0;		//PSR0
+			if (v & 0x02) s->pre1 = 0;		//PSR1
+			if (v & 0x04) oc_act(s, PIN_OC1A, (s->data[IO_TCCR1] >> 4) & 3);	//FOC1A
+			if (v & 0x08) oc_act(s, PIN_OC1B, (v >> 4) & 3);					//FOC1B
+			s->data[a] = v & 0xF0;
+			oc_update(s);
+			return;
+		case IO_TCCR0A:
+		case IO_TCCR1:
+			s->data[a] = v;
+			oc_update(s);
+			return;
+		case IO_SPL:
+		case IO_SPH:						//a frame allocated with out
+			s->data[a] = v;
+			stk_chk(s);
+			return;
+	}
+	s->data[a] = v;
+}
+
+//timer0: one timer clock
+//normal, ctc and fast pwm modes. phase correct modes count up only
+static void t0_clk(SIM_TypeDef *s) {
+	uint8_t *d = s->data;
+	uint8_t wgm = ((d[IO_TCCR0B] >> 1) & 4) | (d[IO_TCCR0A] & 3);
+	uint8_t top = ((wgm == 2) || (wgm == 5) || (wgm == 7)) ? d[IO_OCR0A] : 0xFF;
+	uint8_t n = d[IO_TCNT0];
+	uint8_t pwm = wgm & 1;
+
+	if (!s->t0_block) {
+		if (n == d[IO_OCR0A]) {
+			flag_set(s, IO_TIFR, 4);		//OCF0A
+			if (!pwm) oc_act(s, PIN_OC0A, d[IO_TCCR0A] >> 6);
+		}
+		if (n == d[IO_OCR0B]) {
+			flag_set(s, IO_TIFR, 3);		//OCF0B
+			if (!pwm) oc_act(s, PIN_OC0B, (d[IO_TCCR0A] >> 4) & 3);
+		}
+	}
+	s->t0_block = 0;
+	if ((n == top) || (n == 0xFF)) {
+		d[IO_TCNT0] = 0;
+		if ((n == 0xFF) || (wgm == 7)) flag_set(s, IO_TIFR, 1);	//TOV0: at MAX, or at TOP in fast pwm
+	} else d[IO_TCNT0] = n + 1;
+}
+
+//timer1 (8-bit, attiny25/45/85): one timer clock
+//ctc (CTC1) clears after the OCR1C match. pwm modes run to OCR1C and set TOV1 there
+static void t1_clk(SIM_TypeDef *s) {
+	uint8_t *d = s->data;
+	uint8_t n = d[IO_TCNT1];
+	uint8_t pwm = (d[IO_TCCR1] & 0x40) || (d[IO_GTCCR] & 0x40);
+
+	if (!s->t1_block) {
+		if (n == d[IO_OCR1A]) {
+			flag_set(s, IO_TIFR, 6);		//OCF1A
+			if (!(d[IO_TCCR1] & 0x40)) oc_act(s, PIN_OC1A, (d[IO_TCCR1] >> 4) & 3);
+		}
+		if (n == d[IO_OCR1B]) {
+			flag_set(s, IO_TIFR, 5);		//OCF1B
+			if (!(d[IO_GTCCR] & 0x40)) oc_act(s, PIN_OC1B, (d[IO_GTCCR] >> 4) & 3);
+		}
+	}
+	s->t1_block = 0;
+	if (((d[IO_TCCR1] & 0x80) || pwm) && (n == d[IO_OCR1C])) {
+		d[IO_TCNT1] = 0;
+		if (pwm) flag_set(s, IO_TIFR, 2);	//TOV1
+	} else if (n == 0xFF) {
+		d[IO_TCNT1] = 0;
+		flag_set(s, IO_TIFR, 2);			//TOV1
+	} else d[IO_TCNT1] = n + 1;
+}
+
+//account n cycles of supply current
+static void power(SIM_TypeDef *s, int n) {
+	uint8_t prr = s->data[IO_PRR];
+	double mhz = s->f_cpu / 1e6;
+
+	s->q[SIM_P_CPU] += (s->sleep ? SIM_I_IDLE : SIM_I_ACT) * mhz * n;
+	if (prr & 0x04) s->q_off[SIM_P_TIM0] += SIM_I_TIM0 * mhz * n; else s->q[SIM_P_TIM0] += SIM_I_TIM0 * mhz * n;
+	if (prr & 0x08) s->q_off[SIM_P_TIM1] += SIM_I_TIM1 * mhz * n; else s->q[SIM_P_TIM1] += SIM_I_TIM1 * mhz * n;
+	if (prr & 0x02) s->q_off[SIM_P_USI] += SIM_I_USI * mhz * n; else s->q[SIM_P_USI] += SIM_I_USI * mhz * n;
+	if (prr & 0x01) s->q_off[SIM_P_ADC] += SIM_I_ADCD * mhz * n; else s->q[SIM_P_ADC] += SIM_I_ADCD * mhz * n;
+	if (s->data[IO_ADCSRA] & 0x80) s->q[SIM_P_ADC] += SIM_I_ADCA * n;
+	if (s->data[IO_ACSR] & 0x80) s->q_off[SIM_P_AC] += SIM_I_AC * n; else s->q[SIM_P_AC] += SIM_I_AC * n;
+	if (s->bod) s->q[SIM_P_BOD] += SIM_I_BOD * n;	//a fuse setting, not gated at run time
+}
+
+//advance the peripherals by n cycles
+static void tick(SIM_TypeDef *s, int n) {
+	uint8_t *d = s->data;
+	uint8_t prev, cs;
+
+	power(s, n);
+	while (n--) {
+		s->cyc += 1;
+		//input synchronizer, and pin change detection on its output
+		prev = s->sync;
+		s->sync = s->s1;
+		s->s1 = s->lvl;
+		if ((prev ^ s->sync) & d[IO_PCMSK]) flag_set(s, IO_GIFR, 5);	//PCIF
+		//timer0: clk/1, 8, 64, 256, 1024
+		s->pre0 = (s->pre0 + 1) & 0x3FF;
+		cs = d[IO_TCCR0B] & 7;
+		if ((cs >= 1) && (cs <= 5) && !(d[IO_PRR] & 0x04)) {
+			static const uint16_t m0[6] = {0, 0, 7, 63, 255, 1023};
+			if ((s->pre0 & m0[cs]) == 0) t0_clk(s);
+		}
+		//timer1: clk/2^(cs-1)
+		s->pre1 = (s->pre1 + 1) & 0x3FFF;
+		cs = d[IO_TCCR1] & 0x0F;
+		if (cs && !(d[IO_PRR] & 0x08) && ((s->pre1 & ((1u << (cs - 1)) - 1)) == 0)) t1_clk(s);
+		//analog comparator, with its propagation delay
+		if (!(d[IO_ACSR] & 0x80)) {
+			uint8_t v = ((d[IO_ACSR] & 0x40) ? 1100 : s->ain[0]) > s->ain[1];
+			if (v != s->aco_nxt) {
+				s->aco_nxt = v;
+				s->aco_t = s->cyc + SIM_AC_DLY;
+			}
+			if ((s->aco != s->aco_nxt) && (s->cyc >= s->aco_t)) {
+				uint8_t acis = d[IO_ACSR] & 3;
+				s->aco = s->aco_nxt;
+				if ((acis == 0) || ((acis == 2) && !s->aco) || ((acis == 3) && s->aco)) flag_set(s, IO_ACSR, 4);	//ACI
+			}
+		}
+		if (s->cyc_cb) s->cyc_cb(s);
+	}
+}
+
+//reset the emulator
+void sim_init(SIM_TypeDef *s, const SIM_PartTypeDef *part, double f_cpu) {
+	uint16_t ramend = part->ramend;
+
+	memset(s, 0, sizeof(*s));				//sim_free() first when reusing s
+	memset(s->flash, 0xFF, sizeof(s->flash));
+	s->part = part;
+	s->f_cpu = f_cpu;
+	s->vcc = 3000;
+	s->data[IO_SPL] = ramend;
+	s->data[IO_SPH] = ramend >> 8;
+	for (ramend = 0; ramend < SIM_VECS; ramend++) s->isr[ramend].min = s->isr[ramend].lat_min = 0xFFFFFFFFul;
+	s->fn.min = s->edge.lat_min = s->stamp.lat_min = 0xFFFFFFFFul;
+}
+
+int sim_inject(SIM_TypeDef *s, uint8_t vec, uint32_t period, uint32_t jit, uint32_t body, uint64_t seed) {
+	SIM_LoadTypeDef *l;
+
+	if ((s->nload == SIM_LOADS) || !vec || (vec >= SIM_VECS) || !period || (jit >= period) || !body) return 1;
+	l = &s->load[s->nload++];
+	memset(l, 0, sizeof(*l));
+	l->vec = vec;
+	l->period = period;
+	l->jit = jit;
+	l->body = body;
+	l->rng = seed;
+	l->next = s->cyc + period / 2 + (seed % period);	//loads out of step with each other and the firmware
+	return 0;
+}
+
+//profile calls to a function
+void sim_prof(SIM_TypeDef *s, uint32_t addr) {
+	s->fn_pc = addr >> 1;
+}
+
+//a call landed on the profiled function: sp is where its ret returns the stack pointer to
+static void fn_call(SIM_TypeDef *s, uint16_t sp) {
+	if (s->fn_on || !s->fn_pc || (s->pc != s->fn_pc)) return;
+	s->fn_on = 1;
+	s->fn_sp = sp;
+	s->fn_evt = 1;
+}
+
+//a ret: did it leave the profiled function
+static void fn_ret(SIM_TypeDef *s) {
+	if (s->fn_on && ((s->data[IO_SPL] | (s->data[IO_SPH] << 8)) == s->fn_sp)) {
+		s->fn_on = 0;
+		s->fn_evt = 2;
+	}
+}
+
+//release the symbol table
+void sim_free(SIM_TypeDef *s) {
+	uint32_t i;
+
+	for (i = 0; i < s->nsym; i++) free(s->sym[i].name);
+	free(s->sym);
+	s->sym = NULL;
+	s->nsym = 0;
+}
+
+//flash / data address of a symbol
+int32_t sim_sym(const SIM_TypeDef *s, const char *name) {
+	uint32_t i;
+
+	for (i = 0; i < s->nsym; i++)
+		if (!strcmp(s->sym[i].name, name)) return s->sym[i].addr;
+	return -1;
+}
+
+//pending, enabled interrupt with the highest priority, or 0
+static uint8_t pending(SIM_TypeDef *s) {
+	uint8_t i;
+
+	for (i = 0; i < NSRC; i++)
+		if ((s->data[_src[i].flag] & (1<<_src[i].fbit)) && (s->data[_src[i].mask] & (1<<_src[i].mbit))) return i + 1;
+	return 0;
+}
+
+//stack
+static void push(SIM_TypeDef *s, uint8_t v) {
+	uint16_t sp = s->data[IO_SPL] | (s->data[IO_SPH] << 8);
+	wr(s, sp, v);
+	sp -= 1;
+	s->data[IO_SPL] = sp; s->data[IO_SPH] = sp >> 8;
+	stk_chk(s);
+}
+
+static uint8_t pop(SIM_TypeDef *s) {
+	uint16_t sp = (s->data[IO_SPL] | (s->data[IO_SPH] << 8)) + 1;
+	s->data[IO_SPL] = sp; s->data[IO_SPH] = sp >> 8;
+	return rd(s, sp);
+}
+
+static void push_pc(SIM_TypeDef *s, uint16_t pc) {
+	push(s, pc);
+	push(s, pc >> 8);
+}
+
+static uint16_t pop_pc(SIM_TypeDef *s) {
+	uint16_t pc = pop(s) << 8;
+	return pc | pop(s);
+}
+
+//competing load with the lowest vector pending, + 1, or 0
+static uint8_t load_pending(SIM_TypeDef *s) {
+	uint8_t j, best = 0;
+
+	for (j = 0; j < s->nload; j++)
+		if (s->load[j].pend && (!best || (s->load[j].vec < s->load[best - 1].vec))) best = j + 1;
+	return best;
+}
+
+//raise the load requests that are due. splitmix64 for the spread
+static void load_req(SIM_TypeDef *s) {
+	SIM_LoadTypeDef *l;
+	uint64_t z;
+	uint8_t j;
+
+	for (j = 0; j < s->nload; j++)
+		for (l = &s->load[j]; s->cyc >= l->next; ) {
+			l->req += 1;
+			if (l->pend) l->lost += 1;
+			else {
+				l->pend = 1;
+				s->raised[l->vec] = l->next;
+			}
+			z = (l->rng += 0x9E3779B97F4A7C15ull);
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			z ^= z >> 31;
+			l->next += l->period + (l->jit ? (int64_t) (z % (2 * l->jit + 1)) - l->jit : 0);
+		}
+}
+
+//enter the isr at vector v: 4 cycle response
+static int enter(SIM_TypeDef *s, uint8_t v) {
+	uint64_t lat = s->cyc - s->raised[v];
+	SIM_IsrTypeDef *st = &s->isr[v];
+
+	if (lat < st->lat_min) st->lat_min = lat;
+	if (lat > st->lat_max) st->lat_max = lat;
+	if (s->nest < SIM_NEST) {
+		s->nest_vec[s->nest] = v;
+		s->nest_t0[s->nest] = s->cyc;
+	}
+	if (!s->nest) s->isr_sp = s->data[IO_SPL] | (s->data[IO_SPH] << 8);
+	s->nest += 1;
+	if (s->isr_cb) s->isr_cb(s, v, 1);
+	push_pc(s, s->pc);
+	s->data[IO_SREG] &=~F_I;
+	s->pc = v;								//one word vectors
+	tick(s, 4);
+	return 4;
+}
+
+//take an interrupt, flag cleared by the hardware
+static int take(SIM_TypeDef *s, uint8_t i) {
+	s->data[_src[i].flag] &=~(1<<_src[i].fbit);
+	return enter(s, _src[i].vec);
+}
+
+//take a competing load: its body runs from the next step
+static int take_load(SIM_TypeDef *s, uint8_t j) {
+	s->load[j].pend = 0;
+	enter(s, s->load[j].vec);
+	s->load_run = 1;
+	s->load_end = s->cyc + s->load[j].body;
+	return 4;
+}
+
+//close the innermost isr at reti
+static void isr_done(SIM_TypeDef *s) {
+	SIM_IsrTypeDef *st;
+	uint32_t dt;
+
+	if (!s->nest) return;					//reti outside an isr
+	s->nest -= 1;
+	if (s->isr_cb) s->isr_cb(s, (s->nest < SIM_NEST) ? s->nest_vec[s->nest] : 0xFF, 0);
+	if (s->nest >= SIM_NEST) return;
+	st = &s->isr[s->nest_vec[s->nest]];
+	dt = s->cyc - s->nest_t0[s->nest];
+	st->n += 1;
+	st->sum += dt;
+	if (dt < st->min) st->min = dt;
+	if (dt > st->max) st->max = dt;
+}
+
+//flags
+static void f_add(SIM_TypeDef *s, uint8_t a, uint8_t b, uint8_t r) {
+	uint8_t c = (a & b) | (b & ~r) | (~r & a);
+	uint8_t v = (a & b & ~r) | (~a & ~b & r);
+	uint8_t f = s->data[IO_SREG] & (F_I | F_T);
+
+	if (c & 0x80) f |= F_C;
+	if (c & 0x08) f |= F_H;
+	if (v & 0x80) f |= F_V;
+	if (r & 0x80) f |= F_N;
+	if (r == 0) f |= F_Z;
+	if (((f & F_N) != 0) ^ ((f & F_V) != 0)) f |= F_S;
+	s->data[IO_SREG] = f;
+}
+
+//sub / cp. keepz: sbc / cpc - Z only stays set
+static void f_sub(SIM_TypeDef *s, uint8_t a, uint8_t b, uint8_t r, uint8_t keepz) {
+	uint8_t c = (~a & b) | (b & r) | (r & ~a);
+	uint8_t v = (a & ~b & ~r) | (~a & b & r);
+	uint8_t f = s->data[IO_SREG] & (F_I | F_T);
+
+	if (c & 0x80) f |= F_C;
+	if (c & 0x08) f |= F_H;
+	if (v & 0x80) f |= F_V;
+	if (r & 0x80) f |= F_N;
+	if ((r == 0) && (!keepz || (s->data[IO_SREG] & F_Z))) f |= F_Z;
+	if (((f & F_N) != 0) ^ ((f & F_V) != 0)) f |= F_S;
+	s->data[IO_SREG] = f;
+}
+
+//N, Z, S from r with V given. C and H kept unless in mask
+static void f_nzv(SIM_TypeDef *s, uint8_t r, uint8_t v, uint8_t keep, uint8_t set) {
+	uint8_t f = (s->data[IO_SREG] & keep) | set;
+
+	if (v) f |= F_V;
+	if (r & 0x80) f |= F_N;
+	if (r == 0) f |= F_Z;
+	if (((f & F_N) != 0) ^ ((f & F_V) != 0)) f |= F_S;
+	s->data[IO_SREG] = f;
+}
+
+//two word instructions: lds, sts, jmp, call
+static int is2w(uint16_t op) {
+	return ((op & 0xFE0F) == 0x9000) || ((op & 0xFE0F) == 0x9200) || ((op & 0xFE0C) == 0x940C);
+}
+
+//skip the next instruction: returns the extra cycles
+static int skip(SIM_TypeDef *s) {
+	uint16_t nx = s->flash[s->pc & (SIM_FLASH / 2 - 1)];
+
+	s->pc += is2w(nx) ? 2 : 1;
+	return is2w(nx) ? 2 : 1;
+}
+
+//16-bit pointer registers
+#define PTR(n)				(s->data[n] | (s->data[(n) + 1] << 8))
+#define PTR_SET(n, v)		do {s->data[n] = (v); s->data[(n) + 1] = (v) >> 8;} while (0)
+
+//execute one instruction. returns its cycles
+static int exec(SIM_TypeDef *s) {
+	uint8_t *R = s->data;
+	uint16_t op = s->flash[s->pc & (SIM_FLASH / 2 - 1)];
+	uint16_t pc0 = s->pc;
+	uint8_t d = (op >> 4) & 0x1F, r = (op & 0x0F) | ((op >> 5) & 0x10);
+	uint8_t dh = 16 + ((op >> 4) & 0x0F), K = ((op >> 4) & 0xF0) | (op & 0x0F);
+	uint8_t a, b, res, c;
+	uint16_t w, p;
+
+	s->pc += 1;
+	switch (op >> 12) {
+	case 0x0:
+		switch ((op >> 10) & 3) {
+		case 0:
+			if (op == 0x0000) return 1;									//nop
+			if ((op & 0xFF00) == 0x0100) {								//movw
+				R[((op >> 4) & 0x0F) * 2] = R[(op & 0x0F) * 2];
+				R[((op >> 4) & 0x0F) * 2 + 1] = R[(op & 0x0F) * 2 + 1];
+				return 1;
+			}
+			if ((op & 0xFF00) == 0x0200) {								//muls
+				int16_t m = (int8_t) R[dh] * (int8_t) R[16 + (op & 0x0F)];
+				w = m;
+			} else if ((op & 0xFF88) == 0x0300) {						//mulsu
+				int16_t m = (int8_t) R[16 + ((op >> 4) & 7)] * R[16 + (op & 7)];
+				w = m;
+			} else break;
+			R[0] = w; R[1] = w >> 8;
+			R[IO_SREG] = (R[IO_SREG] & ~(F_C | F_Z)) | ((w & 0x8000) ? F_C : 0) | (w ? 0 : F_Z);
+			return 2;
+		case 1:															//cpc
+			a = R[d]; b = R[r]; res = a - b - (R[IO_SREG] & F_C);
+			f_sub(s, a, b, res, 1);
+			return 1;
+		case 2:															//sbc
+			a = R[d]; b = R[r]; res = a - b - (R[IO_SREG] & F_C);
+			f_sub(s, a, b, res, 1);
+			R[d] = res;
+			return 1;
+		case 3:															//add / lsl
+			a = R[d]; b = R[r]; res = a + b;
+			f_add(s, a, b, res);
+			R[d] = res;
+			return 1;
+		}
+		break;
+	case 0x1:
+		switch ((op >> 10) & 3) {
+		case 0:															//cpse
+			if (R[d] == R[r]) return 1 + skip(s);
+			return 1;
+		case 1:															//cp
+			a = R[d]; b = R[r]; res = a - b;
+			f_sub(s, a, b, res, 0);
+			return 1;
+		case 2:															//sub
+			a = R[d]; b = R[r]; res = a - b;
+			f_sub(s, a, b, res, 0);
+			R[d] = res;
+			return 1;
+		case 3:															//adc / rol
+			a = R[d]; b = R[r]; res = a + b + (R[IO_SREG] & F_C);
+			f_add(s, a, b, res);
+			R[d] = res;
+			return 1;
+		}
+		break;
+	case 0x2:
+		switch ((op >> 10) & 3) {
+		case 0: res = R[d] & R[r]; break;								//and / tst
+		case 1: res = R[d] ^ R[r]; break;								//eor / clr
+		case 2: res = R[d] | R[r]; break;								//or
+		default: R[d] = R[r]; return 1;									//mov
+		}
+		R[d] = res;
+		f_nzv(s, res, 0, F_I | F_T | F_H | F_C, 0);
+		return 1;
+	case 0x3:															//cpi
+		a = R[dh]; res = a - K;
+		f_sub(s, a, K, res, 0);
+		return 1;
+	case 0x4:															//sbci
+		a = R[dh]; res = a - K - (R[IO_SREG] & F_C);
+		f_sub(s, a, K, res, 1);
+		R[dh] = res;
+		return 1;
+	case 0x5:															//subi
+		a = R[dh]; res = a - K;
+		f_sub(s, a, K, res, 0);
+		R[dh] = res;
+		return 1;
+	case 0x6:															//ori / sbr
+		R[dh] |= K;
+		f_nzv(s, R[dh], 0, F_I | F_T | F_H | F_C, 0);
+		return 1;
+	case 0x7:															//andi / cbr
+		R[dh] &= K;
+		f_nzv(s, R[dh], 0, F_I | F_T | F_H | F_C, 0);
+		return 1;
+	case 0x8:
+	case 0xA:															//ldd / std Y+q, Z+q
+		p = PTR((op & 0x08) ? 28 : 30) + ((op & 7) | ((op >> 7) & 0x18) | ((op >> 8) & 0x20));
+		if (op & 0x0200) wr(s, p, R[d]);
+		else R[d] = rd(s, p);
+		return 2;
+	case 0x9:
+		if ((op & 0xFC00) == 0x9000) {									//loads / stores
+			uint8_t st = (op >> 9) & 1;
+			switch (op & 0x0F) {
+			case 0x0:													//lds / sts
+				p = s->flash[s->pc & (SIM_FLASH / 2 - 1)];
+				s->pc += 1;
+				if (st) wr(s, p, R[d]); else R[d] = rd(s, p);
+				return 2;
+			case 0x1: case 0x2: case 0x9: case 0xA: case 0xC: case 0xD: case 0xE: {
+				uint8_t n = ((op & 0x0C) == 0x0C) ? 26 : (op & 0x08) ? 28 : 30;
+				p = PTR(n);
+				if ((op & 3) == 2) p -= 1;								//pre-decrement
+				if (st) wr(s, p, R[d]); else R[d] = rd(s, p);
+				if ((op & 3) == 1) p += 1;								//post-increment
+				PTR_SET(n, p);
+				return (!st && ((op & 3) == 2)) ? 3 : 2;				//AVRe: ld -X/-Y/-Z takes 3, st -X/-Y/-Z 2
+			}
+			case 0x4: case 0x5:											//lpm Rd, Z(+)
+				if (st) break;
+				p = PTR(30);
+				R[d] = s->flash[(p >> 1) & (SIM_FLASH / 2 - 1)] >> ((p & 1) * 8);
+				if (op & 1) {p += 1; PTR_SET(30, p);}
+				return 3;
+			case 0xF:													//pop / push
+				if (st) push(s, R[d]); else R[d] = pop(s);
+				return 2;
+			}
+			break;
+		}
+		if ((op & 0xFE00) == 0x9400) {									//one operand
+			switch (op & 0x0F) {
+			case 0x0:													//com
+				R[d] = ~R[d];
+				f_nzv(s, R[d], 0, F_I | F_T | F_H, F_C);
+				return 1;
+			case 0x1:													//neg
+				a = R[d]; res = 0 - a; R[d] = res;
+				f_sub(s, 0, a, res, 0);
+				return 1;
+			case 0x2:													//swap
+				R[d] = (R[d] << 4) | (R[d] >> 4);
+				return 1;
+			case 0x3:													//inc
+				R[d] += 1;
+				f_nzv(s, R[d], R[d] == 0x80, F_I | F_T | F_H | F_C, 0);
+				return 1;
+			case 0x5: case 0x6: case 0x7:								//asr / lsr / ror
+				a = R[d];
+				c = a & 1;
+				res = a >> 1;
+				if ((op & 0x0F) == 0x5) res |= a & 0x80;
+				if ((op & 0x0F) == 0x7) res |= (R[IO_SREG] & F_C) << 7;
+				R[d] = res;
+				f_nzv(s, res, ((res >> 7) ^ c) & 1, F_I | F_T | F_H, c ? F_C : 0);
+				return 1;
+			case 0xA:													//dec
+				R[d] -= 1;
+				f_nzv(s, R[d], R[d] == 0x7F, F_I | F_T | F_H | F_C, 0);
+				return 1;
+			case 0xC: case 0xD:											//jmp
+				s->pc = s->flash[s->pc & (SIM_FLASH / 2 - 1)];
+				return 3;
+			case 0xE: case 0xF:											//call
+				p = s->data[IO_SPL] | (s->data[IO_SPH] << 8);
+				push_pc(s, s->pc + 1);
+				s->pc = s->flash[s->pc & (SIM_FLASH / 2 - 1)];
+				fn_call(s, p);
+				return 4;
+			case 0x8:
+				if ((op & 0xFF0F) == 0x9408) {							//bset / bclr
+					if (op & 0x80) R[IO_SREG] &=~(1 << ((op >> 4) & 7));
+					else {
+						R[IO_SREG] |= 1 << ((op >> 4) & 7);
+						if (((op >> 4) & 7) == 7) s->ei_hold = 1;		//sei: one more instruction first
+					}
+					return 1;
+				}
+				switch (op) {
+				case 0x9508:											//ret
+					s->pc = pop_pc(s);
+					fn_ret(s);
+					return 4;
+				case 0x9518:											//reti
+					s->pc = pop_pc(s);
+					R[IO_SREG] |= F_I;
+					s->ei_hold = 1;
+					tick(s, 4);
+					isr_done(s);
+					return -4;											//already ticked
+				case 0x9588:											//sleep
+					if (R[IO_MCUCR] & 0x20) s->sleep = 1;				//SE
+					return 1;
+				case 0x9598:											//break
+					s->stop = SIM_BREAK;
+					s->stop_pc = pc0;
+					return 1;
+				case 0x95A8:											//wdr
+					return 1;
+				case 0x95C8:											//lpm r0, Z
+					p = PTR(30);
+					R[0] = s->flash[(p >> 1) & (SIM_FLASH / 2 - 1)] >> ((p & 1) * 8);
+					return 3;
+				case 0x95E8:											//spm: not modelled
+					return 1;
+				}
+				break;
+			case 0x9:
+				if (op == 0x9409) {										//ijmp
+					s->pc = PTR(30);
+					return 2;
+				}
+				if (op == 0x9509) {										//icall
+					p = s->data[IO_SPL] | (s->data[IO_SPH] << 8);
+					push_pc(s, s->pc);
+					s->pc = PTR(30);
+					fn_call(s, p);
+					return 3;
+				}
+				break;
+			}
+			break;
+		}
+		if ((op & 0xFE00) == 0x9600) {									//adiw / sbiw
+			uint8_t n = 24 + ((op >> 4) & 3) * 2;
+			uint16_t k = ((op >> 2) & 0x30) | (op & 0x0F), v0 = PTR(n), v1;
+			uint8_t f = R[IO_SREG] & (F_I | F_T | F_H);
+			if (op & 0x0100) {
+				v1 = v0 - k;
+				if (v1 & ~v0 & 0x8000) f |= F_C;
+				if (v0 & ~v1 & 0x8000) f |= F_V;
+			} else {
+				v1 = v0 + k;
+				if (~v1 & v0 & 0x8000) f |= F_C;
+				if (~v0 & v1 & 0x8000) f |= F_V;
+			}
+			if (v1 & 0x8000) f |= F_N;
+			if (v1 == 0) f |= F_Z;
+			if (((f & F_N) != 0) ^ ((f & F_V) != 0)) f |= F_S;
+			R[IO_SREG] = f;
+			PTR_SET(n, v1);
+			return 2;
+		}
+		if ((op & 0xFC00) == 0x9800) {									//cbi / sbic / sbi / sbis
+			uint8_t io = 0x20 + ((op >> 3) & 0x1F), bit = 1 << (op & 7);
+			switch ((op >> 8) & 3) {
+			case 0: wr(s, io, rd(s, io) & ~bit); return 2;				//cbi
+			case 1: return (rd(s, io) & bit) ? 1 : 1 + skip(s);		//sbic
+			case 2: wr(s, io, rd(s, io) | bit); return 2;				//sbi
+			case 3: return (rd(s, io) & bit) ? 1 + skip(s) : 1;		//sbis
+			}
+		}
+		if ((op & 0xFC00) == 0x9C00) {									//mul
+			w = R[d] * R[r];
+			R[0] = w; R[1] = w >> 8;
+			R[IO_SREG] = (R[IO_SREG] & ~(F_C | F_Z)) | ((w & 0x8000) ? F_C : 0) | (w ? 0 : F_Z);
+			return 2;
+		}
+		break;
+	case 0xB:															//in / out
+		a = 0x20 + ((op & 0x0F) | ((op >> 5) & 0x30));
+		if (op & 0x0800) wr(s, a, R[d]);
+		else R[d] = rd(s, a);
+		return 1;
+	case 0xC:															//rjmp
+		s->pc += ((int16_t) (op << 4)) >> 4;
+		return 2;
+	case 0xD:															//rcall
+		p = s->data[IO_SPL] | (s->data[IO_SPH] << 8);
+		push_pc(s, s->pc);
+		s->pc += ((int16_t) (op << 4)) >> 4;
+		fn_call(s, p);
+		return 3;
+	case 0xE:															//ldi / ser
+		R[dh] = K;
+		return 1;
+	case 0xF:
+		if (!(op & 0x0800)) {											//brbs / brbc
+			uint8_t set = (R[IO_SREG] >> (op & 7)) & 1;
+			if (set ^ ((op >> 10) & 1)) {
+				s->pc += ((int16_t) (op << 6)) >> 9;
+				return 2;
+			}
+			return 1;
+		}
+		if (op & 0x0008) break;
+		switch ((op >> 9) & 3) {
+		case 0:															//bld
+			if (R[IO_SREG] & F_T) R[d] |= 1 << (op & 7); else R[d] &=~(1 << (op & 7));
+			return 1;
+		case 1:															//bst
+			if (R[d] & (1 << (op & 7))) R[IO_SREG] |= F_T; else R[IO_SREG] &=~F_T;
+			return 1;
+		case 2:															//sbrc
+			return (R[d] & (1 << (op & 7))) ? 1 : 1 + skip(s);
+		case 3:															//sbrs
+			return (R[d] & (1 << (op & 7))) ? 1 + skip(s) : 1;
+		}
+		break;
+	}
+	//not decoded
+	s->stop = SIM_ILLEGAL;
+	s->stop_pc = pc0;
+	s->pc = pc0;
+	return 1;
+}
+
+//execute one instruction, one sleeping cycle, or an interrupt response
+int sim_step(SIM_TypeDef *s) {
+	uint8_t hold = s->ei_hold, i;
+	uint64_t t0;
+	int n;
+
+	if (s->stop) return 0;
+	if (s->nload) load_req(s);
+	if (s->load_run) {						//a load's body: a cycle at a time, so its requests and the timers go on
+		tick(s, 1);
+		if (s->cyc >= s->load_end) {		//its reti
+			s->load_run = 0;
+			s->pc = pop_pc(s);
+			s->data[IO_SREG] |= F_I;
+			s->ei_hold = 1;
+			isr_done(s);
+		}
+		return 1;
+	}
+	s->ei_hold = 0;
+	if ((s->data[IO_SREG] & F_I) && !hold && ((i = pending(s)) || (s->nload && load_pending(s)))) {
+		uint8_t j = s->nload ? load_pending(s) : 0;
+
+		n = 0;
+		if (s->sleep) {						//wake up first: 4 more cycles
+			s->sleep = 0;
+			tick(s, 4);
+			n = 4;
+		}
+		if (j && (!i || (s->load[j - 1].vec < _src[i - 1].vec))) return n + take_load(s, j - 1);
+		return n + take(s, i - 1);
+	}
+	if (s->sleep) {
+		if (!(s->data[IO_SREG] & F_I)) {	//nothing can wake it
+			s->stop = SIM_SLEEPDEAD;
+			s->stop_pc = s->pc;
+			return 0;
+		}
+		tick(s, 1);
+		return 1;
+	}
+	t0 = s->cyc;
+	n = exec(s);
+	if (n < 0) return -n;					//reti ticks its own cycles
+	tick(s, n);
+	if (s->fn_evt == 1) s->fn_t0 = t0;		//profiled function entered / left
+	else if (s->fn_evt == 2) {
+		uint32_t dt = s->cyc - s->fn_t0;
+		s->fn.n += 1;
+		s->fn.sum += dt;
+		if (dt < s->fn.min) s->fn.min = dt;
+		if (dt > s->fn.max) s->fn.max = dt;
+	}
+	s->fn_evt = 0;
+	return n;
+}
+
+//run until cycle cyc
+int sim_run(SIM_TypeDef *s, uint64_t cyc) {
+	while (!s->stop && (s->cyc < cyc)) sim_step(s);
+	return s->stop;
+}
+
+//drive a pin from outside
+void sim_drive(SIM_TypeDef *s, uint8_t bit, uint8_t level) {
+	if ((s->stamp_pin & (1 << bit)) && (level != !!(s->ext & (1 << bit)))) {	//a rising edge to time. one not
+		s->stamp_on = level;												//sampled by the fall never was
+		s->stamp_t0 = s->cyc;
+	}
+	if (level) s->ext |= 1 << bit; else s->ext &=~(1 << bit);
+	if (bit < 2) s->ain[bit] = level ? s->vcc : 0;		//PB0 = AIN0, PB1 = AIN1
+	pins_update(s);
+}
+
+//set a comparator input
+void sim_ain(SIM_TypeDef *s, uint8_t ch, uint16_t mv) {
+	s->ain[ch & 1] = mv;
+}
+
+//average current of a block so far
+double sim_ua(const SIM_TypeDef *s, uint8_t blk) {
+	return s->cyc ? s->q[blk] / s->cyc : 0;
+}
+
+//average current gating has saved, against the reset state
+double sim_ua_saved(const SIM_TypeDef *s, uint8_t blk) {
+	return s->cyc ? s->q_off[blk] / s->cyc : 0;
+}
+
+//little endian fields
+static uint32_t le16(const uint8_t *p) {return p[0] | (p[1] << 8);}
+static uint32_t le32(const uint8_t *p) {return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);}
+
+//place an image byte in flash
+static int put(SIM_TypeDef *s, uint32_t addr, uint8_t v) {
+	if (addr >= s->part->flash) return -1;
+	if (addr & 1) s->flash[addr >> 1] = (s->flash[addr >> 1] & 0x00FF) | (v << 8);
+	else s->flash[addr >> 1] = (s->flash[addr >> 1] & 0xFF00) | v;
+	return 0;
+}
+
+//elf: PT_LOAD segments below the data space offset go to flash. symbols are kept
+static int load_elf(SIM_TypeDef *s, const uint8_t *f, long len) {
+	uint32_t phoff = le32(f + 28), shoff = le32(f + 32), i, j;
+	uint16_t phn = le16(f + 44), phs = le16(f + 42), shn = le16(f + 48), shs = le16(f + 46);
+
+	if ((f[4] != 1) || (f[5] != 1) || (le16(f + 18) != 83)) return -1;	//elf32, little endian, EM_AVR
+	for (i = 0; i < phn; i++) {
+		const uint8_t *ph = f + phoff + i * phs;
+		uint32_t off = le32(ph + 4), pa = le32(ph + 12), sz = le32(ph + 16);
+		if ((le32(ph) != 1) || (pa >= 0x800000)) continue;				//PT_LOAD, flash
+		if (off + sz > (uint32_t) len) return -1;
+		for (j = 0; j < sz; j++) if (put(s, pa + j, f[off + j])) return -1;
+	}
+	for (i = 0; i < shn; i++) {
+		const uint8_t *sh = f + shoff + i * shs, *lk, *sy;
+		uint32_t n, str;
+		if (le32(sh + 4) != 2) continue;								//SHT_SYMTAB
+		lk = f + shoff + le32(sh + 24) * shs;
+		str = le32(lk + 16);
+		sy = f + le32(sh + 16);
+		n = le32(sh + 20) / 16;
+		s->sym = calloc(n, sizeof(SIM_SymTypeDef));
+		for (j = 0; s->sym && (j < n); j++, sy += 16) {
+			const char *nm = (const char *) f + str + le32(sy);
+			if (!*nm || ((sy[12] & 0x0F) > 2)) continue;				//STT_NOTYPE / OBJECT / FUNC only
+			s->sym[s->nsym].name = strdup(nm);
+			s->sym[s->nsym].addr = le32(sy + 4);
+			s->sym[s->nsym].size = le32(sy + 8);
+			s->nsym += 1;
+		}
+		break;
+	}
+	return 0;
+}
+
+//intel hex
+static int load_hex(SIM_TypeDef *s, FILE *fp) {
+	char ln[600];
+	uint32_t base = 0;
+
+	while (fgets(ln, sizeof(ln), fp)) {
+		unsigned n, a, t, v, i;
+		if ((ln[0] != ':') || (sscanf(ln + 1, "%2x%4x%2x", &n, &a, &t) != 3)) continue;
+		if (t == 1) break;
+		if ((t == 2) || (t == 4)) {
+			sscanf(ln + 9, "%4x", &v);
+			base = (t == 2) ? v << 4 : v << 16;
+			continue;
+		}
+		if (t) continue;
+		for (i = 0; i < n; i++) {
+			if (sscanf(ln + 9 + i * 2, "%2x", &v) != 1) return -1;
+			if (put(s, base + a + i, v)) return -1;
+		}
+	}
+	return 0;
+}
+
+//load an image
+int sim_load(SIM_TypeDef *s, const char *path) {
+	FILE *fp = fopen(path, "rb");
+	uint8_t *buf;
+	long len;
+	int ret;
+
+	if (!fp) return -1;
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	buf = malloc(len + 1);
+	if (!buf || (fread(buf, 1, len, fp) != (size_t) len)) {
+		free(buf);
+		fclose(fp);
+		return -1;
+	}
+	if ((len > 52) && !memcmp(buf, "\177ELF", 4)) ret = load_elf(s, buf, len);
+	else {
+		fseek(fp, 0, SEEK_SET);
+		ret = load_hex(s, fp);
+	}
+	free(buf);
+	fclose(fp);
+	return ret;
+}
@@ -0,0 +1,186 @@
+#ifndef _AVRSIM_H
+#define _AVRSIM_H
+//header file for the host side avr emulator
+//cycle true avr core (the avr25 instruction set avr-gcc emits for the attiny25/45/85) plus the
+//peripherals the 1pps engine touches: timer0, timer1 (8-bit), gpio / pin change, analog comparator, PRR
+//runs the compiled firmware (elf or intel hex) and measures every isr in cpu cycles
+//all times are cpu cycles since reset. the clock model (cycles -> seconds) is the caller's
+
+#include <stdint.h>
+
+//configuration
+#define SIM_FLASH			32768			//largest flash image, bytes
+#define SIM_DATA			0x0900			//data space: registers + io + sram
+#define SIM_VECS			32				//largest vector table
+#define SIM_NEST			8				//deepest isr nesting tracked
+#define SIM_AC_DLY			4				//analog comparator propagation delay, cycles (~0.5us at 8Mhz)
+#define SIM_LOADS			4				//most competing isr loads (sim_inject)
+//end configuration
+
+//stop reasons
+#define SIM_RUN				0				//still running
+#define SIM_BREAK			1				//BREAK instruction
+#define SIM_ILLEGAL			2				//undecoded opcode
+#define SIM_SLEEPDEAD		3				//sleeping with interrupts off: never wakes
+
+//part description
+typedef struct {
+	const char *name;
+	uint16_t flash;							//flash size, bytes
+	uint16_t ramstart;						//first sram address
+	uint16_t ramend;						//last sram address
+	uint8_t nvec;							//vectors, including reset
+	const char *vec[SIM_VECS];				//vector names, for reports
+} SIM_PartTypeDef;
+
+//per isr statistics
+typedef struct {
+	uint32_t n;								//invocations
+	uint32_t min, max;						//cycles, from acceptance (4 cycle response included) to the end of reti
+	uint64_t sum;
+	uint32_t lat_min, lat_max;				//cycles from the flag being raised to acceptance
+} SIM_IsrTypeDef;
+
+//competing isr load: requests on a vector, each taking the cpu for body cycles once accepted - by the rules the
+//firmware's own isrs follow: the lowest pending vector first, none while an isr runs (I clear), 4 cycle response
+//it stands in for work the firmware under test does not contain: a soft uart, pin change, adc or usi handler
+typedef struct {
+	uint8_t vec;							//vector: its priority, and where its figures go in isr[]
+	uint32_t period;						//cycles between requests
+	uint32_t jit;							//each request moved by up to +/- jit cycles, uniformly
+	uint32_t body;							//cycles from its first instruction to the end of its reti
+	uint64_t next;							//cycle of the next request
+	uint64_t rng;
+	uint8_t pend;							//requested, not yet accepted
+	uint32_t req, lost;						//requests, and those made while the last was still pending
+} SIM_LoadTypeDef;
+
+//power model: average current, by block
+#define SIM_P_CPU			0				//core: active / idle / power-down
+#define SIM_P_TIM0			1
+#define SIM_P_TIM1			2
+#define SIM_P_USI			3
+#define SIM_P_ADC			4				//adc digital (PRADC) + analog (ADEN)
+#define SIM_P_AC			5				//analog comparator
+#define SIM_P_BOD			6				//brown-out detector (fuse)
+#define SIM_P_BLOCKS		7
+
+//symbols, from an elf image
+typedef struct {
+	char *name;
+	uint32_t addr;							//flash: byte address. data: 0x800000 + data address
+	uint32_t size;
+} SIM_SymTypeDef;
+
+typedef struct SIM_TypeDef SIM_TypeDef;
+
+//emulator state
+struct SIM_TypeDef {
+	const SIM_PartTypeDef *part;
+	double f_cpu;							//cpu clock, Hz - for the power model only
+	//core
+	uint16_t flash[SIM_FLASH / 2];
+	uint8_t data[SIM_DATA];
+	uint16_t pc;							//word address
+	uint64_t cyc;							//cycles since reset
+	uint8_t ei_hold;						//1: one more instruction before an interrupt (after sei / reti)
+	uint8_t sleep;							//1: sleeping
+	uint8_t stop;							//SIM_RUN or the stop reason
+	uint16_t stop_pc;						//where it stopped
+	//interrupts
+	uint64_t raised[SIM_VECS];				//cycle each pending flag was raised at, for latency
+	uint8_t nest;							//isrs in progress
+	uint8_t nest_vec[SIM_NEST];
+	uint64_t nest_t0[SIM_NEST];
+	SIM_IsrTypeDef isr[SIM_VECS];
+	SIM_LoadTypeDef load[SIM_LOADS];		//competing isr loads
+	uint8_t nload;
+	uint8_t load_run;						//1: a load's body has the cpu, until load_end
+	uint64_t load_end;
+	//function profile (sim_prof): cycles from the start of the call to the end of the ret. lat_* unused
+	SIM_IsrTypeDef fn;
+	uint16_t fn_pc;							//word address profiled, 0: none
+	uint16_t fn_sp;							//stack pointer the ret returns to
+	uint64_t fn_t0;
+	uint8_t fn_on, fn_evt;					//in the function / 1: entered, 2: left, in this instruction
+	//edge latency: rising edges on edge_pin, timed from the flag of the isr driving them to the start
+	//of the instruction that drives the pin. n, lat_min, lat_max used
+	uint8_t edge_pin;						//pin mask, 0: none
+	SIM_IsrTypeDef edge;
+	//stamp latency: rising edges driven onto stamp_pin (sim_drive), timed to the first read of the data address
+	//stamp_reg from an isr in stamp_vecs - the counter sample of a reference input. n, sum, lat_min, lat_max used
+	uint8_t stamp_pin;						//pin mask, 0: none
+	uint16_t stamp_reg;						//e.g. TCNT0
+	uint32_t stamp_vecs;					//vector mask
+	uint8_t stamp_on;						//an edge waits for its sample
+	uint64_t stamp_t0;
+	SIM_IsrTypeDef stamp;
+	//stack depth in bytes: the main loop's deepest below ramend, and the deepest an isr went below the stack pointer
+	//it was accepted at (return address included). an isr lands on some main loop frame: their sum bounds the stack
+	uint16_t stk_main, stk_isr;
+	uint16_t isr_sp;						//stack pointer the outermost isr was accepted at
+	//timers
+	uint16_t pre0;							//timer0 prescaler
+	uint16_t pre1;							//timer1 prescaler
+	uint8_t t0_block;						//1: TCNT0 written - no compare match on the next timer clock
+	uint8_t t1_block;
+	uint8_t oc;								//compare output latches, as pin levels
+	uint8_t oc_en;							//pins driven by a compare output
+	//gpio
+	uint8_t ext;							//levels driven onto the pins from outside
+	uint8_t s1, sync;						//input synchronizer: PINx reads sync
+	uint8_t lvl;							//pin levels
+	void (*pin_cb)(SIM_TypeDef *s, uint8_t old, uint8_t lvl);	//called when a pin level changes
+	void (*isr_cb)(SIM_TypeDef *s, uint8_t vec, uint8_t in);	//called as an isr is accepted (in = 1) and at the end of its reti
+	void (*cyc_cb)(SIM_TypeDef *s);		//called every cycle, after the timers - costly: set it for a window only
+	void *user;
+	//analog comparator
+	uint16_t ain[2];						//AIN0 / AIN1 in mV
+	uint16_t vcc;							//mV
+	uint8_t aco, aco_nxt;					//comparator output, and where it is heading
+	uint64_t aco_t;							//cycle the output settles at
+	//power
+	uint8_t bod;							//1: brown-out detector enabled by fuse
+	double q[SIM_P_BLOCKS];					//charge, uA * cycles
+	double q_off[SIM_P_BLOCKS];				//charge saved by gating, uA * cycles
+	//symbols
+	SIM_SymTypeDef *sym;
+	uint32_t nsym;
+};
+
+//parts
+extern const SIM_PartTypeDef sim_tiny25, sim_tiny45, sim_tiny85;
+const SIM_PartTypeDef *sim_part(const char *name);
+
+//reset the emulator: part, cpu clock in Hz
+void sim_init(SIM_TypeDef *s, const SIM_PartTypeDef *part, double f_cpu);
+//release the symbol table
+void sim_free(SIM_TypeDef *s);
+
+//load an image: elf (with symbols) or intel hex. returns 0 on success
+int sim_load(SIM_TypeDef *s, const char *path);
+//flash / data address of a symbol, or -1
+int32_t sim_sym(const SIM_TypeDef *s, const char *name);
+
+//profile calls to the function at flash byte address addr (see sim_sym())
+void sim_prof(SIM_TypeDef *s, uint32_t addr);
+
+//add a competing isr load on vector vec: a request every period cycles, +/- jit, body cycles each. returns 0 on success
+int sim_inject(SIM_TypeDef *s, uint8_t vec, uint32_t period, uint32_t jit, uint32_t body, uint64_t seed);
+
+//execute one instruction (or one sleeping cycle, or an interrupt response). returns the cycles taken
+int sim_step(SIM_TypeDef *s);
+//run until cycle cyc, or until it stops. returns s->stop
+int sim_run(SIM_TypeDef *s, uint64_t cyc);
+
+//drive pin bit from outside: level 0/1. comparator inputs follow the pin (0 / vcc mV)
+void sim_drive(SIM_TypeDef *s, uint8_t bit, uint8_t level);
+//set a comparator input: ch 0 = AIN0, 1 = AIN1, in mV
+void sim_ain(SIM_TypeDef *s, uint8_t ch, uint16_t mv);
+
+//average current of a block so far, uA, and what gating it has saved
+double sim_ua(const SIM_TypeDef *s, uint8_t blk);
+double sim_ua_saved(const SIM_TypeDef *s, uint8_t blk);
+extern const char *sim_pname[SIM_P_BLOCKS];
+
+#endif
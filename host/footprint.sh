@@ -0,0 +1,168 @@
+#!/bin/sh
+#footprint: flash / sram used by each module, for every build configuration below
+#
+#usage:	host/footprint.sh [-u]
+#	builds the firmware with avr-gcc for each configuration, links it with section gc and a map file, and splits
+#	the flash (text + initialised data) and sram (data + bss) of the image by the object file it came from
+#	-u: write the current figures to host/footprint.ref - the report then shows growth against it
+#
+#modules: main (the pps engine), tmr0oc, tmr1oc, delay, telem, refin, disc, rdiv, gpio. rt = vectors, crt and libgcc
+#the MCU_MINI configuration is also linked with -flto: lto merges the modules, so only its total is reported
+#the attiny images (the MCU_MINI one as linked with lto) also run in avrrun for 8 seconds with a gps pps on REF_PIN:
+#the main loop's deepest stack plus the deepest isr's bounds the stack, checked against the sram left over
+#fails (exit 1) when an image does not fit its part, when that stack bound does not fit the sram left over, or when
+#a module's flash exceeds its budget in BUDGET (per feature: raise one deliberately, as with the reference)
+#environment: CC (avr-gcc), SIZE (avr-size), HOSTCC (cc)
+
+set -e
+UPD=$1
+cd "$(dirname "$0")/.."
+CC=${CC:-avr-gcc}
+SIZE=${SIZE:-avr-size}
+HOSTCC=${HOSTCC:-cc}
+REF=host/footprint.ref
+OUT=${TMPDIR:-/tmp}/footprint.$$
+mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+
+#configurations: name mcu flags. plans are from the examples in main.c
+T0="-DF_CPU=2430000ul -DF_OSC=19440000ul -DPS_FUSE=8 -DPS_TMR=8 -DTMR_TOP=243 -DISR_CNT=1250"
+T1="-DF_CPU=2000000ul -DF_OSC=16000000ul -DPS_FUSE=8 -DPS_TMR=64 -DTMR_TOP=31250 -DISR_CNT=1 -DPPS_DC=10000 -DPPS_TIMER=1"
+CONFIGS="default:attiny85:$T0
+notelem:attiny85:$T0 -DTELEM_CPU=0
+gpior:attiny85:$T0 -DPPS_STATE=PPS_GPIOR
+pcint:attiny85:$T0 -DREF_SRC=REF_PCINT
+acomp:attiny85:$T0 -DREF_SRC=REF_ACOMP
+acomp45:attiny45:$T0 -DREF_SRC=REF_ACOMP
+mini25:attiny25:$T0 -DMCU_MINI=1
+tmr1:atmega328p:$T1
+tmr1icp:atmega328p:$T1 -DREF_SRC=REF_ICP"
+MODS="main tmr0oc tmr1oc delay telem refin disc rdiv gpio rt"
+#flash budget of each feature's module, bytes, in any configuration
+BUDGET="main:1024 tmr0oc:384 tmr1oc:384 delay:128 telem:512 refin:256 disc:768 rdiv:256 gpio:192"
+
+#flash / sram of a part, bytes
+part() {
+	case $1 in
+	attiny25) echo "2048 128";;
+	attiny45) echo "4096 256";;
+	attiny85) echo "8192 512";;
+	atmega328p) echo "32768 2048";;
+	*) echo "0 0";;
+	esac
+}
+
+#map file -> "<module> <flash> <sram>" per module. input sections are attributed to the object they came from
+#a long section name puts the address / size / object on the next line
+mapsplit() {
+	awk -v mods="$MODS" '
+	function hex(x,    i, v) {v = 0; x = tolower(substr(x, 3)); for (i = 1; i <= length(x); i++) v = v * 16 + index("0123456789abcdef", substr(x, i, 1)) - 1; return v}
+	BEGIN {n = split(mods, m, " "); for (i = 1; i <= n; i++) {fl[m[i]] = 0; ram[m[i]] = 0}}
+	/^Linker script and memory map/ {on = 1; next}
+	!on {next}
+	/^ [.A-Za-z_]/ && NF == 1 {sec = $1; next}
+	/^ [.A-Za-z_]/ && NF >= 4 && $2 ~ /^0x/ && $3 ~ /^0x/ {sec = $1; sz = $3; obj = $4}
+	/^                / && NF == 3 && $1 ~ /^0x/ && $2 ~ /^0x/ && sec != "" {sz = $2; obj = $3}
+	obj != "" {
+		b = obj; sub(/.*\//, "", b); sub(/\.o$/, "", b); sub(/\.o\)$/, "", b)
+		if (!(b in fl)) b = "rt"
+		sz = hex(sz)
+		if (sec ~ /^\.(text|vectors|init|fini|progmem|trampolines|jumptables|lowtext|ctors|dtors)/) fl[b] += sz
+		else if (sec ~ /^\.(data|rodata)/) {fl[b] += sz; ram[b] += sz}
+		else if (sec ~ /^(\.bss|\.noinit|COMMON)/) ram[b] += sz
+		obj = ""; sec = ""
+	}
+	END {for (i = 1; i <= n; i++) print m[i], fl[m[i]], ram[m[i]]}' "$1"
+}
+
+$HOSTCC -O2 -o "$OUT/avrrun" host/avrrun.c host/avrsim.c host/osc.c host/gps.c host/trace.c host/golden.c host/vcd.c -lm
+: > "$OUT/now"
+echo "$CONFIGS" | while IFS=: read name mcu flags; do
+	srcs="main.c gpio.c delay.c telem.c rdiv.c refin.c disc.c"
+	case "$flags" in *PPS_TIMER=1*) srcs="$srcs tmr1oc.c";; *) srcs="$srcs tmr0oc.c";; esac
+	objs=
+	for c in $srcs; do
+		$CC -mmcu=$mcu -Os -std=gnu99 -ffunction-sections -fdata-sections $flags -c -o "$OUT/${c%.c}.o" $c
+		objs="$objs $OUT/${c%.c}.o"
+	done
+	$CC -mmcu=$mcu -Wl,--gc-sections -Wl,-Map="$OUT/fw.map" -o "$OUT/fw.elf" $objs
+	mapsplit "$OUT/fw.map" | while read mod fl ram; do echo "$name $mcu $mod $fl $ram"; done >> "$OUT/now"
+	elf="$OUT/fw.elf"
+	case "$flags" in *MCU_MINI=1*)
+		$CC -mmcu=$mcu -Os -std=gnu99 -flto -ffunction-sections -fdata-sections -Wl,--gc-sections $flags -o "$OUT/lto.elf" $srcs
+		$SIZE -A "$OUT/lto.elf" | awk -v c="$name $mcu" '
+			$1 ~ /^\.(text|data)$/ {fl += $2} $1 ~ /^\.(data|bss|noinit)$/ {ram += $2}
+			END {print c, "lto", fl + 0, ram + 0}' >> "$OUT/now"
+		elf="$OUT/lto.elf";;
+	esac
+	case $mcu in attiny*)					#stack high water: "<config> <mcu> stack <main loop> <isr>"
+		fcpu=$(echo "$flags" | sed 's/.*-DF_CPU=\([0-9]*\).*/\1/')
+		"$OUT/avrrun" -p $mcu -f $fcpu -t 8 -g timing -r "$elf" | tr ' ' '\n' |
+			awk -F: -v c="$name $mcu" '$1 == "stack" {print c, "stack", $2, $3}' >> "$OUT/now";;
+	esac
+done
+
+if [ "$UPD" = "-u" ] || [ ! -f $REF ]; then
+	cp "$OUT/now" $REF
+	echo "footprint: reference written to $REF"
+fi
+
+#one row per configuration: flash/sram per module, total, and growth against the reference
+awk -v mods="$MODS" -v budget="$BUDGET" -v parts="$(for p in attiny25 attiny45 attiny85 atmega328p; do echo "$p $(part $p)"; done | tr '\n' ';')" '
+BEGIN {
+	n = split(mods, m, " ")
+	np = split(parts, pl, ";")
+	for (i = 1; i <= np; i++) {split(pl[i], q, " "); pfl[q[1]] = q[2]; pram[q[1]] = q[3]}
+	nb = split(budget, bl, " ")
+	for (i = 1; i <= nb; i++) {split(bl[i], q, ":"); bud[q[1]] = q[2]}
+}
+FNR == NR {rfl[$1, $3] = $4; rram[$1, $3] = $5; next}
+$3 == "stack" {stk[$1] = $4 + $5; stkm[$1] = $4; stki[$1] = $5; next}
+{
+	if (!($1 in mcu)) {order[++nc] = $1; mcu[$1] = $2}
+	fl[$1, $3] = $4; ram[$1, $3] = $5
+	if ($3 != "lto") {tfl[$1] += $4; tram[$1] += $5}
+}
+END {
+	printf "%-10s %-10s", "config", "mcu"
+	for (i = 1; i <= n; i++) printf " %9s", m[i]
+	printf " %11s %11s\n", "total", "lto"
+	for (j = 1; j <= nc; j++) {
+		c = order[j]
+		printf "%-10s %-10s", c, mcu[c]
+		for (i = 1; i <= n; i++) printf " %9s", fl[c, m[i]] "/" ram[c, m[i]]
+		printf " %11s %11s\n", tfl[c] "/" tram[c], ((c, "lto") in fl) ? fl[c, "lto"] "/" ram[c, "lto"] : "-"
+	}
+	printf "\n(flash/sram, bytes)\n"
+	for (j = 1; j <= nc; j++) {
+		c = order[j]
+		for (i = 1; i <= n + 1; i++) {
+			k = (i <= n) ? m[i] : "lto"
+			if (!((c, k) in fl) || !((c, k) in rfl)) continue
+			if ((fl[c, k] != rfl[c, k]) || (ram[c, k] != rram[c, k]))
+				printf "  %s %s: flash %d -> %d (%+d), sram %d -> %d (%+d)\n", c, k, rfl[c, k], fl[c, k],
+					fl[c, k] - rfl[c, k], rram[c, k], ram[c, k], ram[c, k] - rram[c, k]
+		}
+		for (i = 1; i <= n; i++)
+			if ((m[i] in bud) && (fl[c, m[i]] > bud[m[i]])) {
+				printf "  OVER BUDGET %s %s: flash %d of %d\n", c, m[i], fl[c, m[i]], bud[m[i]]
+				bad = 1
+			}
+		f = ((c, "lto") in fl) ? fl[c, "lto"] : tfl[c]
+		r = ((c, "lto") in fl) ? ram[c, "lto"] : tram[c]
+		if ((f > pfl[mcu[c]]) || (r > pram[mcu[c]])) {
+			printf "  DOES NOT FIT %s %s: flash %d of %d, sram %d of %d\n", c, mcu[c], f, pfl[mcu[c]], r, pram[mcu[c]]
+			bad = 1
+			continue
+		}
+		printf "  %-10s %-10s flash %5.1f%%, sram %5.1f%% (%d bytes left for the stack", c, mcu[c],
+			100.0 * f / pfl[mcu[c]], 100.0 * r / pram[mcu[c]], pram[mcu[c]] - r
+		if (c in stk) printf ", %d deep: %d main loop + %d isr)\n", stk[c], stkm[c], stki[c]
+		else printf ", not emulated)\n"
+		if ((c in stk) && (stk[c] > pram[mcu[c]] - r)) {
+			printf "  STACK OVERFLOW %s %s: %d bytes deep, %d left\n", c, mcu[c], stk[c], pram[mcu[c]] - r
+			bad = 1
+		}
+	}
+	exit bad
+}' $REF "$OUT/now"
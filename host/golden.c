@@ -0,0 +1,107 @@
+#include <string.h>
+#include "golden.h"							//we record and replay isr events
+
+#define GOLD_MAGIC			"PPSGOLD1"
+
+//compare registers, data space addresses
+static const uint8_t _ocr[5] = {0x49, 0x48, 0x4E, 0x4B, 0x4D};	//OCR0A, OCR0B, OCR1A, OCR1B, OCR1C
+
+static void pack(uint8_t *p, const GOLD_EventTypeDef *e) {
+	uint8_t i;
+
+	for (i = 0; i < 8; i++) p[i] = e->cyc >> (8 * i);
+	p[8] = e->kind;
+	p[9] = e->vec;
+	p[10] = e->pins;
+	memcpy(p + 11, e->ocr, 5);
+}
+
+static void unpack(const uint8_t *p, GOLD_EventTypeDef *e) {
+	uint8_t i;
+
+	for (e->cyc = 0, i = 0; i < 8; i++) e->cyc |= (uint64_t) p[i] << (8 * i);
+	e->kind = p[8];
+	e->vec = p[9];
+	e->pins = p[10];
+	memcpy(e->ocr, p + 11, 5);
+}
+
+int gold_open(GOLD_TypeDef *g, const char *path, uint8_t record) {
+	uint8_t h[16];
+
+	memset(g, 0, sizeof(*g));
+	g->rec = record;
+	if (!(g->fp = fopen(path, record ? "wb" : "rb"))) return 1;
+	setvbuf(g->fp, NULL, _IOFBF, 1 << 20);	//a run makes millions of events
+	if (record) {
+		memset(h, 0, sizeof(h));
+		memcpy(h, GOLD_MAGIC, 8);
+		h[8] = GOLD_REC;
+		return fwrite(h, 1, sizeof(h), g->fp) != sizeof(h);
+	}
+	if ((fread(h, 1, sizeof(h), g->fp) != sizeof(h)) || memcmp(h, GOLD_MAGIC, 8) || (h[8] != GOLD_REC)) {
+		fclose(g->fp);
+		g->fp = NULL;
+		return 1;
+	}
+	return 0;
+}
+
+uint8_t gold_event(GOLD_TypeDef *g, const GOLD_EventTypeDef *e) {
+	uint8_t p[GOLD_REC];
+
+	if (g->diverged || !g->fp) return g->diverged;
+	g->n += 1;
+	pack(p, e);
+	if (g->rec) {
+		if (fwrite(p, 1, GOLD_REC, g->fp) != GOLD_REC) g->diverged = 1;
+		return g->diverged;
+	}
+	g->got = *e;
+	if (fread(p, 1, GOLD_REC, g->fp) != GOLD_REC) return g->diverged = 2;
+	unpack(p, &g->want);
+	if ((g->want.cyc != e->cyc) || (g->want.kind != e->kind) || (g->want.vec != e->vec) || (g->want.pins != e->pins) ||
+		memcmp(g->want.ocr, e->ocr, 5)) return g->diverged = 1;
+	g->last = *e;
+	return 0;
+}
+
+uint8_t gold_sim(GOLD_TypeDef *g, const SIM_TypeDef *s, uint8_t kind, uint8_t vec) {
+	GOLD_EventTypeDef e;
+	uint8_t i;
+
+	e.cyc = s->cyc;
+	e.kind = kind;
+	e.vec = vec;
+	if (kind == GOLD_PIN) e.vec = (s->nest && (s->nest <= SIM_NEST)) ? s->nest_vec[s->nest - 1] : 0xFF;
+	e.pins = s->lvl;
+	for (i = 0; i < 5; i++) e.ocr[i] = s->data[_ocr[i]];
+	return gold_event(g, &e);
+}
+
+uint8_t gold_close(GOLD_TypeDef *g) {
+	uint8_t p[GOLD_REC];
+
+	if (!g->fp) return g->diverged;
+	if (g->rec) g->diverged |= (fclose(g->fp) != 0);
+	else {
+		if (!g->diverged && (fread(p, 1, GOLD_REC, g->fp) == GOLD_REC)) {
+			unpack(p, &g->want);
+			g->n += 1;
+			g->diverged = 3;
+		}
+		fclose(g->fp);
+	}
+	g->fp = NULL;
+	return g->diverged;
+}
+
+const char *gold_str(const GOLD_EventTypeDef *e, const char *const *names, char *buf, uint32_t len) {
+	static const char *const kind[] = {"enter", "reti", "pins"};
+	const char *v = (e->vec == 0xFF) ? "-" : names[e->vec] ? names[e->vec] : "?";
+
+	snprintf(buf, len, "cycle %llu %-5s %-12s PB=%02x OCR0A=%3u OCR0B=%3u OCR1A=%3u OCR1B=%3u OCR1C=%3u",
+		(unsigned long long) e->cyc, (e->kind < 3) ? kind[e->kind] : "?", v, e->pins,
+		e->ocr[0], e->ocr[1], e->ocr[2], e->ocr[3], e->ocr[4]);
+	return buf;
+}
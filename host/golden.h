@@ -0,0 +1,48 @@
+#ifndef _GOLDEN_H
+#define _GOLDEN_H
+//header file for the golden trace: bit exact record and replay of a run's isr events
+//a reference run records every isr acceptance, every reti and every pin change with its cycle, the pin levels and
+//the compare registers; later builds replay the same run against it and stop at the first event that differs.
+//an edge of tmr0oc / tmr1oc / pps_out moved by a single cycle shows up as the event it moved
+//the file: a header (GOLD_MAGIC, record size) then GOLD_REC byte records, little endian
+
+#include <stdio.h>
+#include <stdint.h>
+#include "avrsim.h"						//events come from the emulator
+
+#define GOLD_REC			16				//record size, bytes
+
+//event kinds
+#define GOLD_ENTER			0				//isr accepted (the cycle the 4 cycle response starts)
+#define GOLD_RETI			1				//end of its reti
+#define GOLD_PIN			2				//pin levels changed
+
+typedef struct {
+	uint64_t cyc;							//cycles since reset
+	uint8_t kind;
+	uint8_t vec;							//isr vector. pin changes: the isr they happened in, 0xFF outside any
+	uint8_t pins;							//pin levels PB0..PB5, after the event
+	uint8_t ocr[5];							//OCR0A, OCR0B, OCR1A, OCR1B, OCR1C
+} GOLD_EventTypeDef;
+
+typedef struct {
+	FILE *fp;
+	uint8_t rec;							//1: recording, 0: comparing
+	uint64_t n;								//events so far
+	uint8_t diverged;						//comparing: 1 at the first difference, 2 when the golden run ended first,
+	GOLD_EventTypeDef want, got, last;		//3 when this one did. the golden and this event, and the last that matched
+} GOLD_TypeDef;
+
+//record to path (record = 1) or compare against it. returns 0 on success
+int gold_open(GOLD_TypeDef *g, const char *path, uint8_t record);
+//the next event of this run. returns g->diverged: once set, further events are ignored
+uint8_t gold_event(GOLD_TypeDef *g, const GOLD_EventTypeDef *e);
+//the event the emulator is at: kind, and the isr vector (GOLD_PIN: found from the isrs in progress)
+uint8_t gold_sim(GOLD_TypeDef *g, const SIM_TypeDef *s, uint8_t kind, uint8_t vec);
+//end of the run: a golden run with events left over diverges too. returns g->diverged, or 1 on a write error
+uint8_t gold_close(GOLD_TypeDef *g);
+
+//an event as text, vector names from names[] (the part's)
+const char *gold_str(const GOLD_EventTypeDef *e, const char *const *names, char *buf, uint32_t len);
+
+#endif
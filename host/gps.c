@@ -0,0 +1,146 @@
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "gps.h"							//we model a gps receiver
+
+#ifndef M_PI
+#define M_PI				3.14159265358979323846
+#endif
+
+#define GPS_EPOCH			315964800ul		//gps time 0 (1980-01-06) as unix seconds
+#define GPS_LEAP			18				//gps - utc, seconds (since 2017)
+
+//typical receivers
+//nav: u-blox 6/7 class, 48Mhz receiver clock. timing: u-blox M8T class, tighter and cleaner
+//                                   name      q          q_off    q_rw   jit    delay  p_out  out     p_drop drop width epoch       lat      lon
+const GPS_ParamTypeDef gps_ideal  = {"ideal",  0,         0,       0,     0,     0,     0,     0,      0,     0,   0.1,  1767225600, 47.3769, 8.5417};
+const GPS_ParamTypeDef gps_nav    = {"nav",    1 / 48e6,  1.23e-6, 1e-11, 10e-9, 50e-9, 1e-3,  1e-6,   1e-4,  30,  0.1,  1767225600, 47.3769, 8.5417};
+const GPS_ParamTypeDef gps_timing = {"timing", 1 / 48e6,  3.1e-7,  1e-12, 2e-9,  50e-9, 1e-4,  200e-9, 0,     0,   0.1,  1767225600, 47.3769, 8.5417};
+
+const GPS_ParamTypeDef *gps_param(const char *name) {
+	if (!strcmp(name, "ideal")) return &gps_ideal;
+	if (!strcmp(name, "nav")) return &gps_nav;
+	if (!strcmp(name, "timing")) return &gps_timing;
+	return NULL;
+}
+
+//splitmix64
+static uint64_t rnd(GPS_TypeDef *g) {
+	uint64_t z = (g->rng += 0x9E3779B97F4A7C15ull);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+//uniform [0, 1)
+static double uni(GPS_TypeDef *g) {
+	return (rnd(g) >> 11) / 9007199254740992.0;
+}
+
+//unit gaussian, box-muller
+static double gauss(GPS_TypeDef *g) {
+	double u, v, r;
+
+	if (g->g2_ok) {g->g2_ok = 0; return g->g2;}
+	u = uni(g) + 0.5 / 9007199254740992.0;		//(0, 1)
+	v = uni(g);
+	r = sqrt(-2 * log(u));
+	g->g2 = r * sin(2 * M_PI * v);
+	g->g2_ok = 1;
+	return r * cos(2 * M_PI * v);
+}
+
+//make pulse n
+static void pulse(GPS_TypeDef *g, uint32_t n, GPS_PulseTypeDef *p) {
+	double q = g->p.q / (1 + g->q_off), step;
+
+	p->n = n;
+	p->ok = 1;
+	p->outlier = 0;
+	//the pulse waits for the next receiver clock edge. the clock phase walks by the fraction of a period per second
+	p->qerr = (q && (g->ph > 0)) ? (1 - g->ph) * q : 0;
+	if (q) {
+		step = 1 / q;
+		g->ph += step - floor(step);
+		g->ph -= floor(g->ph);
+		g->q_off += g->p.q_rw * gauss(g);
+	}
+	p->t = n + g->p.delay + p->qerr + g->p.jit * gauss(g);
+	if (uni(g) < g->p.p_out) {
+		p->t += (2 * uni(g) - 1) * g->p.out;
+		p->outlier = 1;
+	}
+	if (!g->drop && g->p.drop && (uni(g) < g->p.p_drop)) g->drop = 1 + rnd(g) % g->p.drop;
+	if (g->drop) {
+		g->drop -= 1;
+		p->ok = 0;
+	}
+}
+
+//append an NMEA sentence: $<body>*<checksum>\r\n
+static void nmea(GPS_TypeDef *g, const char *body) {
+	uint8_t ck = 0;
+	const char *c;
+
+	for (c = body; *c; c++) ck ^= *c;
+	g->msg_len += snprintf((char *) g->msg + g->msg_len, GPS_MSG - g->msg_len, "$%s*%02X\r\n", body, ck);
+}
+
+//append a UBX-TIM-TP frame for pulse p
+static void tim_tp(GPS_TypeDef *g, const GPS_PulseTypeDef *p) {
+	uint8_t *m = g->msg + g->msg_len, ck_a = 0, ck_b = 0, i;
+	uint64_t gs = (uint64_t) g->p.epoch + p->n - GPS_EPOCH + GPS_LEAP;
+	uint32_t tow = (gs % 604800) * 1000;
+	int32_t qerr = (int32_t) lround(p->qerr * 1e12);	//ps
+	uint16_t week = gs / 604800;
+
+	if (g->msg_len + 24 > GPS_MSG) return;
+	m[0] = 0xB5; m[1] = 0x62;				//sync
+	m[2] = 0x0D; m[3] = 0x01;				//class TIM, id TP
+	m[4] = 16; m[5] = 0;					//payload length
+	for (i = 0; i < 4; i++) {
+		m[6 + i] = tow >> (8 * i);			//towMS
+		m[10 + i] = 0;						//towSubMS
+		m[14 + i] = (uint32_t) qerr >> (8 * i);		//qErr, ps
+	}
+	m[18] = week; m[19] = week >> 8;
+	m[20] = 0x02;							//flags: gps time base, utc available
+	m[21] = 0;								//refInfo
+	for (i = 2; i < 22; i++) {ck_a += m[i]; ck_b += ck_a;}	//fletcher, over class .. payload
+	m[22] = ck_a; m[23] = ck_b;
+	g->msg_len += 24;
+}
+
+void gps_init(GPS_TypeDef *g, const GPS_ParamTypeDef *p, uint64_t seed) {
+	memset(g, 0, sizeof(*g));
+	g->p = *p;
+	g->rng = seed;
+	g->ph = uni(g);
+	g->q_off = p->q_off;
+	pulse(g, 0, &g->nxt);
+}
+
+void gps_next(GPS_TypeDef *g, GPS_PulseTypeDef *p) {
+	time_t ut;
+	struct tm *tm;
+	char s[96];
+	double la = fabs(g->p.lat), lo = fabs(g->p.lon);
+
+	*p = g->nxt;
+	pulse(g, p->n + 1, &g->nxt);
+	//what the receiver sends during the second after pulse p
+	g->msg_len = 0;
+	ut = (time_t) g->p.epoch + p->n;
+	tm = gmtime(&ut);
+	snprintf(s, sizeof(s), "GPRMC,%02d%02d%02d.00,%c,%02d%07.4f,%c,%03d%07.4f,%c,0.00,0.00,%02d%02d%02d,,,%c",
+		tm->tm_hour, tm->tm_min, tm->tm_sec, p->ok ? 'A' : 'V',
+		(int) la, (la - (int) la) * 60, (g->p.lat < 0) ? 'S' : 'N', (int) lo, (lo - (int) lo) * 60, (g->p.lon < 0) ? 'W' : 'E',
+		tm->tm_mday, tm->tm_mon + 1, tm->tm_year % 100, p->ok ? 'A' : 'N');
+	nmea(g, s);
+	snprintf(s, sizeof(s), "GPZDA,%02d%02d%02d.00,%02d,%02d,%04d,00,00",
+		tm->tm_hour, tm->tm_min, tm->tm_sec, tm->tm_mday, tm->tm_mon + 1, tm->tm_year + 1900);
+	nmea(g, s);
+	if (g->nxt.ok) tim_tp(g, &g->nxt);		//qErr of the coming pulse
+}
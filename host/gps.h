@@ -0,0 +1,68 @@
+#ifndef _GPS_H
+#define _GPS_H
+//header file for the gps receiver model
+//a gps pps, as the host side stimulus for the reference input: the pulse of second n leaves the receiver at
+//true time n + delay, moved onto the next edge of the receiver's own clock (the quantization sawtooth),
+//plus white jitter, occasional outliers and dropouts
+//after each pulse the receiver sends the messages a real one would: NMEA RMC / ZDA for that second, and a
+//u-blox UBX-TIM-TP with the quantization error (qErr) of the next pulse
+
+#include <stdint.h>
+#include <stddef.h>
+
+//configuration
+#define GPS_MSG				256				//longest message burst after a pulse, bytes
+//end configuration
+
+//model parameters
+typedef struct {
+	const char *name;
+	double q;								//receiver clock period: pulses land on its edges, seconds
+	double q_off;							//receiver clock frequency offset, fractional: sets how fast the sawtooth walks
+	double q_rw;							//random walk of that offset, per second: the sawtooth's hanging bridges come and go
+	double jit;								//white jitter, rms seconds - on top of the sawtooth
+	double delay;							//fixed offset: antenna cable and receiver, seconds
+	double p_out;							//probability of an outlier, per pulse
+	double out;								//outlier size: uniform within +-out, seconds
+	double p_drop;							//probability of a dropout starting, per pulse
+	uint32_t drop;							//longest dropout, pulses: uniform 1..drop
+	double width;							//pulse width, seconds
+	uint32_t epoch;							//utc of pulse 0, unix seconds
+	double lat, lon;						//position reported in RMC, degrees
+} GPS_ParamTypeDef;
+
+//typical receivers. ideal: on the second, no noise
+extern const GPS_ParamTypeDef gps_ideal, gps_nav, gps_timing;
+//model by name (ideal / nav / timing), or NULL
+const GPS_ParamTypeDef *gps_param(const char *name);
+
+//one pulse
+typedef struct {
+	uint32_t n;								//second number
+	uint8_t ok;								//0: dropped - no pulse, no fix
+	uint8_t outlier;						//1: moved by an outlier
+	double t;								//true time of the rising edge, seconds
+	double qerr;							//quantization error: actual - ideal edge, seconds. what TIM-TP reports
+} GPS_PulseTypeDef;
+
+//receiver state
+typedef struct {
+	GPS_ParamTypeDef p;
+	uint64_t rng;							//random generator state
+	double g2;								//spare gaussian
+	uint8_t g2_ok;
+	double ph;								//receiver clock phase at the ideal edge, in clock periods (0..1)
+	double q_off;							//receiver clock frequency offset now
+	uint32_t drop;							//pulses left in the current dropout
+	GPS_PulseTypeDef nxt;					//the next pulse: TIM-TP reports it ahead
+	uint8_t msg[GPS_MSG];					//messages sent after the last pulse
+	size_t msg_len;
+} GPS_TypeDef;
+
+//start a receiver: model, seed
+void gps_init(GPS_TypeDef *g, const GPS_ParamTypeDef *p, uint64_t seed);
+
+//the next pulse. its messages are in g->msg[0..g->msg_len)
+void gps_next(GPS_TypeDef *g, GPS_PulseTypeDef *pulse);
+
+#endif
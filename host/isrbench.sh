@@ -0,0 +1,94 @@
+#!/bin/sh
+#isrbench: worst-case isr cycles, 1pps edge latency and cpu load for every frequency plan / feature combination
+#
+#usage:	host/isrbench.sh [-u]
+#	builds the firmware with avr-gcc for each plan x feature set in matrix.sh, runs it in avrrun for 2 emulated
+#	seconds, prints the figures and compares the worst cases with host/isrbench.ref
+#	-u: write the current figures to host/isrbench.ref - after a deliberate change, or to start one. without it a
+#	    missing reference is a failure: there is nothing to hold the figures to
+#the TIMER1 isrs are not benchmarked: PPS_TIMER 1 needs a 16-bit timer1 (atmega328p, attiny24/44/84), and avrrun
+#emulates the attiny25/45/85 only - matrix.sh holds timer0 plans alone
+#
+#fails (exit 1) when a worst-case isr or pps_out cycle count, or the edge latency bound, grows by more than
+#ISRBENCH_TOL cycles (default 0), or the cpu load grows by more than ISRBENCH_LOAD percentage points (default 0.5),
+#or - REF_PCINT / REF_ACOMP, run again with a gps pps (avrrun -g) - the average reference stamp latency is more than
+#ISRBENCH_REFTOL cycles (default 3) off the REF_LAT the firmware was built with
+#environment: CC (avr-gcc), MCU (attiny85), HOSTCC (cc)
+
+set -e
+UPD=$1
+cd "$(dirname "$0")/.."
+. host/matrix.sh							#PLANS, FEATS, fw_build
+HOSTCC=${HOSTCC:-cc}
+TOL=${ISRBENCH_TOL:-0}
+LOAD=${ISRBENCH_LOAD:-0.5}
+REFTOL=${ISRBENCH_REFTOL:-3}
+REF=host/isrbench.ref
+OUT=${TMPDIR:-/tmp}/isrbench.$$
+mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+
+$HOSTCC -O2 -o "$OUT/avrrun" host/avrrun.c host/avrsim.c host/osc.c host/gps.c host/trace.c host/golden.c host/vcd.c -lm
+: > "$OUT/now"
+for p in $PLANS; do
+	for f in $FEATS; do
+		fw_build $p $f "$OUT/fw.elf"
+		line=$("$OUT/avrrun" -p $MCU -f $F_CPU -t 2 -s pps_out -e 2 -r "$OUT/fw.elf")
+		if [ $FW_REF = REF_PCINT ] || [ $FW_REF = REF_ACOMP ]; then	#stamp latency against REF_LAT, as built
+			lat=$(echo REF_LAT | $CC $flags $FW_FLAGS -include refin.h -E -P - | tail -n 1)
+			stamp=$("$OUT/avrrun" -p $MCU -f $F_CPU -t 4 -g timing -r "$OUT/fw.elf" | tr ' ' '\n' | grep '^ref:')
+			line="$line ${stamp:-ref:0:0:0:0}:$lat"
+		fi
+		echo "$p/$f $line" >> "$OUT/now"
+	done
+done
+
+if [ "$UPD" = "-u" ]; then
+	cp "$OUT/now" $REF
+	echo "isrbench: reference written to $REF"
+elif [ ! -f $REF ]; then
+	cat "$OUT/now"
+	echo "isrbench: no reference $REF - check the figures above, then write it with -u" >&2
+	exit 1
+fi
+
+#isr:<name>:<runs>:<min>:<avg>:<max>:<lat_max>:<load%>  fn:<name>:<runs>:<min>:<avg>:<max>  edge:<runs>:<lat_min>:<lat_max>
+#ref:<stamps>:<lat_min>:<avg>:<lat_max>:<REF_LAT>
+awk -v tol=$TOL -v dload=$LOAD -v reftol=$REFTOL '
+function parse(line, m,    n, i, f, k) {
+	n = split(line, f, " ")
+	k = f[1]
+	keys[k] = 1
+	for (i = 2; i <= n; i++) {
+		split(f[i], g, ":")
+		if (g[1] == "isr") {m[k, g[2] ".max"] = g[6]; m[k, g[2] ".avg"] = g[5]; m[k, g[2] ".lat"] = g[7]; m[k, "load"] += g[8]}
+		if (g[1] == "fn") {m[k, g[2] ".max"] = g[6]; m[k, g[2] ".avg"] = g[5]}
+		if (g[1] == "edge") {m[k, "edge.min"] = g[3]; m[k, "edge.max"] = g[4]}
+		if (g[1] == "ref") {m[k, "ref.lo"] = g[3]; m[k, "ref.avg"] = g[4]; m[k, "ref.hi"] = g[5]; m[k, "ref.lat"] = g[6]}
+	}
+}
+FNR == NR {parse($0, ref); next}
+{parse($0, now); order[++nk] = $1}
+END {
+	printf "%-52s %9s %9s %9s %9s %7s\n", "plan/features", "isr max", "isr avg", "pps_out", "edge", "load%"
+	for (j = 1; j <= nk; j++) {
+		k = order[j]
+		printf "%-52s %9s %9s %9s %4s..%-4s %7.3f\n", k, now[k, "TIM0_COMPA.max"], now[k, "TIM0_COMPA.avg"],
+			now[k, "pps_out.max"], now[k, "edge.min"], now[k, "edge.max"], now[k, "load"]
+		if ((k, "ref.lat") in now) {
+			d = now[k, "ref.avg"] - now[k, "ref.lat"]
+			printf "  reference stamp %s..%s cycles, %s on average, REF_LAT %s\n", now[k, "ref.lo"], now[k, "ref.hi"],
+				now[k, "ref.avg"], now[k, "ref.lat"]
+			if (d > reftol || -d > reftol) {printf "  REF_LAT OFF by %.1f cycles\n", d; bad = 1}
+		}
+		for (x in now) {
+			split(x, q, SUBSEP)
+			if (q[1] != k || !((k, q[2]) in ref)) continue
+			if (q[2] ~ /\.max$/ || q[2] == "edge.max") lim = ref[k, q[2]] + tol
+			else if (q[2] == "load") lim = ref[k, q[2]] + dload
+			else continue
+			if (now[x] + 0 > lim + 0) {printf "  REGRESSION %s: %s -> %s\n", q[2], ref[k, q[2]], now[x]; bad = 1}
+		}
+	}
+	exit bad
+}' $REF "$OUT/now"
@@ -0,0 +1,23 @@
+#matrix: the frequency plans and feature sets the host benchmarks sweep, and how to build one combination
+#sourced by isrbench.sh and comply.sh, from the repository root
+#environment: CC (avr-gcc), MCU (attiny85), FW_FLAGS (more -D options for every build, e.g. -DPPS_MODE=PPS_POLL)
+
+CC=${CC:-avr-gcc}
+MCU=${MCU:-attiny85}
+
+#frequency plans: F_OSC:PS_FUSE:PS_TMR:TMR_TOP:ISR_CNT, from the examples in main.c
+PLANS="19440000:8:8:243:1250 20000000:8:8:250:1250 16000000:8:64:250:125 12800000:8:64:250:100 8000000:8:8:250:500"
+#feature sets: PPS_STATE:TELEM_CPU:REF_SRC
+FEATS="PPS_SRAM:1:REF_NONE PPS_SRAM:0:REF_NONE PPS_GPIOR:1:REF_NONE PPS_REG:1:REF_NONE PPS_SRAM:1:REF_PCINT PPS_SRAM:1:REF_ACOMP"
+SRCS="main.c gpio.c delay.c telem.c tmr0oc.c rdiv.c refin.c disc.c"
+
+#fw_build <plan> <feature set> <elf>: build one combination. sets F_CPU, the cpu clock in Hz, and FW_REF to its REF_SRC
+fw_build() {
+	set -- $(echo $1 $2 | tr : ' ') "$3"
+	F_CPU=$(($1 / $2))
+	FW_REF=$8
+	flags="-mmcu=$MCU -Os -std=gnu99 -DF_CPU=${F_CPU}ul -DF_OSC=${1}ul -DPS_FUSE=$2 -DPS_TMR=$3"
+	flags="$flags -DTMR_TOP=$4 -DISR_CNT=$5 -DPPS_STATE=$6 -DTELEM_CPU=$7 -DREF_SRC=$8"
+	if [ "$6" = PPS_REG ]; then flags="$flags -ffixed-r2 -ffixed-r3"; fi
+	$CC $flags $FW_FLAGS -o "$9" $SRCS
+}
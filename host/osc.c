@@ -0,0 +1,118 @@
+#include <math.h>
+#include <string.h>
+#include "osc.h"							//we model oscillators
+
+#ifndef M_PI
+#define M_PI				3.14159265358979323846
+#endif
+
+//allan deviation of the flicker generator below (unit rows, scaled by 1/sqrt(OSC_FLK)): measured, flat from ~16 to 2^20 tau0
+#define OSC_FFM_K			0.29
+
+//typical parts. rough datasheet figures, at 10..20Mhz
+//                                 name     y0     wpm    fpm    wfm    ffm    rwfm   aging/day tc/K   swing K  period s
+const OSC_ParamTypeDef osc_ideal = {"ideal", 0,     0,     0,     0,     0,     0,     0,        0,     0,       86400};
+const OSC_ParamTypeDef osc_xo    = {"xo",    20e-6, 5e-12, 2e-12, 1e-9,  5e-10, 1e-10, 1.5e-8,   1e-6,  2,       86400};
+const OSC_ParamTypeDef osc_tcxo  = {"tcxo",  5e-7,  2e-12, 1e-12, 2e-10, 1e-10, 1e-11, 3e-9,     5e-9,  2,       86400};
+const OSC_ParamTypeDef osc_ocxo  = {"ocxo",  2e-8,  1e-12, 5e-13, 5e-12, 3e-12, 1e-13, 5e-10,    1e-11, 2,       86400};
+
+const OSC_ParamTypeDef *osc_param(const char *name) {
+	if (!strcmp(name, "ideal")) return &osc_ideal;
+	if (!strcmp(name, "xo")) return &osc_xo;
+	if (!strcmp(name, "tcxo")) return &osc_tcxo;
+	if (!strcmp(name, "ocxo")) return &osc_ocxo;
+	return NULL;
+}
+
+//splitmix64
+static uint64_t rnd(OSC_TypeDef *o) {
+	uint64_t z = (o->rng += 0x9E3779B97F4A7C15ull);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+//unit gaussian, box-muller
+static double gauss(OSC_TypeDef *o) {
+	double u, v, r;
+
+	if (o->g2_ok) {o->g2_ok = 0; return o->g2;}
+	u = ((rnd(o) >> 11) + 0.5) / 9007199254740992.0;	//(0, 1)
+	v = ((rnd(o) >> 11) + 0.5) / 9007199254740992.0;
+	r = sqrt(-2 * log(u));
+	o->g2 = r * sin(2 * M_PI * v);
+	o->g2_ok = 1;
+	return r * cos(2 * M_PI * v);
+}
+
+//one sample of flicker (1/f) noise, unit rms: voss-mccartney - row i is renewed every 2^i samples
+static double flicker(OSC_TypeDef *o, double *row, uint64_t k) {
+	double sum = 0;
+	uint8_t i;
+
+	for (i = 0; (i < OSC_FLK - 1) && !(k & 1); i++) k >>= 1;
+	row[i] = gauss(o);
+	for (i = 0; i < OSC_FLK; i++) sum += row[i];
+	return sum / sqrt(OSC_FLK);
+}
+
+double osc_temp(const OSC_TypeDef *o, double t) {
+	return o->p.t_per ? o->p.t_amp * sin(2 * M_PI * t / o->p.t_per) : 0;
+}
+
+//generate interval k: the frequency over it, and the cycles at its end
+static void gen(OSC_TypeDef *o) {
+	double tm = (o->k + 0.5) * o->tau0, x;		//middle of the interval
+
+	o->y_rw += o->p.rwfm * sqrt(3 * o->tau0) * gauss(o);
+	o->y = o->p.y0 + o->p.aging * tm / 86400 + o->p.tc * osc_temp(o, tm) + o->y_rw +
+		o->p.wfm / sqrt(o->tau0) * gauss(o) + o->p.ffm / OSC_FFM_K * flicker(o, o->flk_fm, o->k + 1);
+	o->x += o->y * o->tau0;
+	o->k += 1;
+	x = o->x + o->p.wpm * gauss(o) + o->p.fpm * flicker(o, o->flk_pm, o->k);
+	o->cyc[o->k % OSC_HIST] = o->f * (o->k * o->tau0 + x);
+}
+
+void osc_init(OSC_TypeDef *o, const OSC_ParamTypeDef *p, double f, double tau0, uint64_t seed) {
+	uint8_t i;
+
+	memset(o, 0, sizeof(*o));
+	o->p = *p;
+	o->f = f;
+	o->tau0 = tau0;
+	o->rng = seed;
+	for (i = 0; i < OSC_FLK; i++) {o->flk_fm[i] = gauss(o); o->flk_pm[i] = gauss(o);}
+	o->cyc[0] = 0;								//the emulator starts at cycle 0 at true time 0
+}
+
+//boundary i, generating up to it. boundaries older than the history read as the oldest kept
+static double bnd(OSC_TypeDef *o, uint64_t i) {
+	while (o->k < i) gen(o);
+	if (i + OSC_HIST <= o->k) i = o->k - OSC_HIST + 1;
+	return o->cyc[i % OSC_HIST];
+}
+
+double osc_cyc(OSC_TypeDef *o, double t) {
+	uint64_t i;
+	double c0;
+
+	if (t <= 0) return t * o->f;
+	i = (uint64_t) (t / o->tau0);
+	c0 = bnd(o, i);
+	return c0 + (bnd(o, i + 1) - c0) * (t / o->tau0 - i);
+}
+
+double osc_time(OSC_TypeDef *o, double cyc) {
+	uint64_t i;
+	double c0, c1;
+
+	if (cyc <= 0) return cyc / o->f;
+	c0 = cyc / o->f - o->x;						//first guess, from the time error so far
+	i = (c0 > 0) ? (uint64_t) (c0 / o->tau0) : 0;
+	while (i && (bnd(o, i) > cyc)) i--;
+	while (bnd(o, i + 1) <= cyc) i++;
+	c0 = bnd(o, i);
+	c1 = bnd(o, i + 1);
+	return (i + (cyc - c0) / (c1 - c0)) * o->tau0;
+}
@@ -0,0 +1,63 @@
+#ifndef _OSC_H
+#define _OSC_H
+//header file for the oscillator models
+//maps the emulator's cpu cycles to true time, for an oscillator with noise, aging and temperature drift
+//the emulator runs in cycles of its own clock. an oscillator that runs fast packs more cycles into a true second:
+//	cycles(t) = f * (t + x(t))		x: time error of the oscillator, seconds
+//x is generated every tau0 seconds of true time and interpolated in between, reproducibly from a seed
+
+#include <stdint.h>
+
+//configuration
+#define OSC_HIST			64				//interval boundaries kept: queries may trail the newest by this many tau0
+#define OSC_FLK				24				//octaves of the flicker noise generators
+//end configuration
+
+//model parameters. noise levels as the allan deviation at tau = 1s, the way datasheets quote them
+typedef struct {
+	const char *name;
+	double y0;								//initial fractional frequency offset
+	double wpm;								//white phase noise: rms time error, seconds
+	double fpm;								//flicker phase noise: rms time error, seconds
+	double wfm;								//white frequency noise: adev at 1s, falls as 1/sqrt(tau)
+	double ffm;								//flicker frequency noise: adev floor, flat in tau
+	double rwfm;							//random walk frequency noise: adev at 1s, grows as sqrt(tau)
+	double aging;							//linear frequency drift, fractional frequency per day
+	double tc;								//temperature coefficient, fractional frequency per kelvin (after compensation)
+	double t_amp;							//temperature swing around the reference, kelvin
+	double t_per;							//period of the swing, seconds
+} OSC_ParamTypeDef;
+
+//typical parts. ideal: no noise, no drift
+extern const OSC_ParamTypeDef osc_ideal, osc_xo, osc_tcxo, osc_ocxo;
+//model by name (ideal / xo / tcxo / ocxo), or NULL
+const OSC_ParamTypeDef *osc_param(const char *name);
+
+//oscillator state
+typedef struct {
+	OSC_ParamTypeDef p;
+	double f;								//nominal frequency, Hz
+	double tau0;							//update interval, seconds
+	uint64_t rng;							//random generator state
+	double g2;								//spare gaussian
+	uint8_t g2_ok;
+	double flk_fm[OSC_FLK], flk_pm[OSC_FLK];	//flicker generator rows
+	uint64_t k;								//intervals generated: boundaries 0..k are known
+	double x;								//frequency part of the time error at boundary k, seconds
+	double y;								//fractional frequency over the last interval generated
+	double y_rw;							//random walk part of the frequency
+	double cyc[OSC_HIST];					//cycles at boundary i, at [i % OSC_HIST]
+} OSC_TypeDef;
+
+//start an oscillator: model, nominal frequency in Hz, update interval in seconds, seed
+void osc_init(OSC_TypeDef *o, const OSC_ParamTypeDef *p, double f, double tau0, uint64_t seed);
+
+//cycles counted at true time t, seconds (fractional)
+double osc_cyc(OSC_TypeDef *o, double t);
+//true time, seconds, at cycle cyc
+double osc_time(OSC_TypeDef *o, double cyc);
+
+//temperature offset of the model at true time t, kelvin
+double osc_temp(const OSC_TypeDef *o, double t);
+
+#endif
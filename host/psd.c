@@ -0,0 +1,163 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "psd.h"							//we estimate phase noise spectra
+
+#ifndef M_PI
+#define M_PI				3.14159265358979323846
+#endif
+
+//vector butterflies the compiler targets
+#if defined(__AVX2__) && defined(__FMA__)
+#define PSD_AVX2			1
+#include <immintrin.h>
+#else
+#define PSD_AVX2			0
+#endif
+#if !PSD_AVX2 && defined(__ARM_NEON) && defined(__aarch64__)
+#define PSD_NEON			1
+#include <arm_neon.h>
+#else
+#define PSD_NEON			0
+#endif
+
+#if PSD_AVX2
+const char *psd_isa = "avx2";
+#elif PSD_NEON
+const char *psd_isa = "neon";
+#else
+const char *psd_isa = "scalar";
+#endif
+uint8_t psd_simd = 1;
+
+int psd_fft_init(PSD_FftTypeDef *p, uint32_t n) {
+	uint32_t h, j, i, r, b;
+
+	memset(p, 0, sizeof(*p));
+	if (!n || (n & (n - 1))) return 1;
+	p->n = n;
+	p->tw = malloc(2 * (n > 1 ? n - 1 : 1) * sizeof(double));
+	p->rev = malloc(n * sizeof(uint32_t));
+	p->z = malloc(2 * n * sizeof(double));
+	if (!p->tw || !p->rev || !p->z) {psd_fft_free(p); return 1;}
+	//each stage's twiddles contiguous, so the vector loop loads them in order
+	for (h = 1; h < n; h *= 2)
+		for (j = 0; j < h; j++) {
+			p->tw[2 * (h - 1 + j)] = cos(M_PI * j / h);
+			p->tw[2 * (h - 1 + j) + 1] = -sin(M_PI * j / h);
+		}
+	for (i = 0; i < n; i++) {
+		for (r = 0, b = 1; b < n; b *= 2) r = (r << 1) | !!(i & b);
+		p->rev[i] = r;
+	}
+	return 0;
+}
+
+void psd_fft_free(PSD_FftTypeDef *p) {
+	free(p->tw);
+	free(p->rev);
+	free(p->z);
+	memset(p, 0, sizeof(*p));
+}
+
+//butterflies of one stage, half size h, for j in [j0, h) of every block
+static void stage_scalar(double *z, const double *w, uint32_t n, uint32_t h, uint32_t j0) {
+	uint32_t b, j;
+	double *a, *c, tr, ti;
+
+	for (b = 0; b < n; b += 2 * h)
+		for (j = j0; j < h; j++) {
+			a = z + 2 * (b + j);
+			c = a + 2 * h;
+			tr = c[0] * w[2 * j] - c[1] * w[2 * j + 1];
+			ti = c[0] * w[2 * j + 1] + c[1] * w[2 * j];
+			c[0] = a[0] - tr; c[1] = a[1] - ti;
+			a[0] += tr; a[1] += ti;
+		}
+}
+
+static void stage_simd(double *z, const double *w, uint32_t n, uint32_t h) {
+#if PSD_AVX2
+	//two complex per vector: t = c * w as [cr wr - ci wi, ci wr + cr wi]
+	uint32_t b, j;
+	__m256d a, c, wv, t;
+
+	if (h < 2) {stage_scalar(z, w, n, h, 0); return;}
+	for (b = 0; b < n; b += 2 * h)
+		for (j = 0; j < h; j += 2) {
+			a = _mm256_loadu_pd(z + 2 * (b + j));
+			c = _mm256_loadu_pd(z + 2 * (b + j + h));
+			wv = _mm256_loadu_pd(w + 2 * j);
+			t = _mm256_fmaddsub_pd(c, _mm256_movedup_pd(wv), _mm256_mul_pd(_mm256_permute_pd(c, 0x5), _mm256_permute_pd(wv, 0xF)));
+			_mm256_storeu_pd(z + 2 * (b + j), _mm256_add_pd(a, t));
+			_mm256_storeu_pd(z + 2 * (b + j + h), _mm256_sub_pd(a, t));
+		}
+#elif PSD_NEON
+	//one complex per vector: t = c * wr + swap(c) * [-wi, wi]
+	uint32_t b, j;
+	float64x2_t a, c, t, wi;
+
+	for (b = 0; b < n; b += 2 * h)
+		for (j = 0; j < h; j++) {
+			a = vld1q_f64(z + 2 * (b + j));
+			c = vld1q_f64(z + 2 * (b + j + h));
+			wi = vsetq_lane_f64(w[2 * j + 1], vdupq_n_f64(-w[2 * j + 1]), 1);
+			t = vfmaq_f64(vmulq_n_f64(c, w[2 * j]), vextq_f64(c, c, 1), wi);
+			vst1q_f64(z + 2 * (b + j), vaddq_f64(a, t));
+			vst1q_f64(z + 2 * (b + j + h), vsubq_f64(a, t));
+		}
+#else
+	stage_scalar(z, w, n, h, 0);
+#endif
+}
+
+void psd_fft(const PSD_FftTypeDef *p) {
+	uint32_t i, r, h;
+	double t;
+
+	for (i = 0; i < p->n; i++)
+		if ((r = p->rev[i]) > i) {
+			t = p->z[2 * i]; p->z[2 * i] = p->z[2 * r]; p->z[2 * r] = t;
+			t = p->z[2 * i + 1]; p->z[2 * i + 1] = p->z[2 * r + 1]; p->z[2 * r + 1] = t;
+		}
+	for (h = 1; h < p->n; h *= 2) {
+		if (psd_simd) stage_simd(p->z, p->tw + 2 * (h - 1), p->n, h);
+		else stage_scalar(p->z, p->tw + 2 * (h - 1), p->n, h, 0);
+	}
+}
+
+uint64_t psd_welch(const double *x, uint64_t n, uint32_t len, double tau0, double *sx) {
+	PSD_FftTypeDef p;
+	double *w, u = 0, sn, si, sxi, sii, a, b, v, k0;
+	uint64_t s, segs = 0;
+	uint32_t i;
+
+	if ((len < 4) || (n < len) || psd_fft_init(&p, len)) return 0;
+	if (!(w = malloc(len * sizeof(double)))) {psd_fft_free(&p); return 0;}
+	for (i = 0; i < len; i++) {
+		w[i] = 0.5 * (1 - cos(2 * M_PI * i / len));	//hann, periodic
+		u += w[i] * w[i];
+	}
+	memset(sx, 0, (len / 2 + 1) * sizeof(double));
+	sn = len; si = len * (len - 1) / 2.0; sii = (len - 1) * len * (2.0 * len - 1) / 6.0;
+	for (s = 0; s + len <= n; s += len / 2, segs++) {
+		//least squares line through the segment: a frequency offset would leak into every bin
+		for (i = 0, v = 0, sxi = 0; i < len; i++) {v += x[s + i]; sxi += x[s + i] * i;}
+		b = (sn * sxi - si * v) / (sn * sii - si * si);
+		a = (v - b * si) / sn;
+		for (i = 0; i < len; i++) {
+			p.z[2 * i] = (x[s + i] - a - b * i) * w[i];
+			p.z[2 * i + 1] = 0;
+		}
+		psd_fft(&p);
+		for (i = 0; i <= len / 2; i++) sx[i] += p.z[2 * i] * p.z[2 * i] + p.z[2 * i + 1] * p.z[2 * i + 1];
+	}
+	//one-sided density: |X|^2 / (fs * sum w^2), doubled except at dc and nyquist
+	for (i = 0; i <= len / 2; i++) {
+		k0 = ((i == 0) || (i == len / 2)) ? 1 : 2;
+		sx[i] *= k0 * tau0 / (u * segs);
+	}
+	free(w);
+	psd_fft_free(&p);
+	return segs;
+}
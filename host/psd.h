@@ -0,0 +1,34 @@
+#ifndef _PSD_H
+#define _PSD_H
+//header file for the phase noise spectrum estimator
+//welch: the phase record is cut into half overlapping segments, each detrended, hann windowed and transformed,
+//and the periodograms averaged into the one-sided phase spectrum S_x(f), s^2/Hz. from it:
+//	S_y(f) = (2 pi f)^2 S_x(f)					fractional frequency, 1/Hz
+//	L(f) = 10 log10((2 pi nu0)^2 S_x(f) / 2)	phase noise of a carrier at nu0 with this time error, dBc/Hz
+//the radix-2 fft has AVX2 / NEON butterflies when the compiler targets them (-march=native), scalar otherwise
+
+#include <stdint.h>
+
+//fft plan
+typedef struct {
+	uint32_t n;								//points, a power of 2
+	double *tw;								//twiddles, per stage: stage of half size h at [2 * (h - 1)], re / im
+	uint32_t *rev;							//bit reversed index
+	double *z;								//work buffer, n complex
+} PSD_FftTypeDef;
+
+//plan an n point fft. returns 0 on success
+int psd_fft_init(PSD_FftTypeDef *p, uint32_t n);
+void psd_fft_free(PSD_FftTypeDef *p);
+//forward fft of p->z in place: n complex, re / im interleaved
+void psd_fft(const PSD_FftTypeDef *p);
+
+//welch estimate of S_x over x[0..n), sampled every tau0 seconds, segments of len points (a power of 2)
+//sx[0..len / 2] gets S_x at f = k / (len * tau0). returns the segments averaged, 0 if n < len or out of memory
+uint64_t psd_welch(const double *x, uint64_t n, uint32_t len, double tau0, double *sx);
+
+//vector butterflies: 1 (default) to use them, 0 for the scalar loop. and the instruction set they use
+extern uint8_t psd_simd;
+extern const char *psd_isa;
+
+#endif
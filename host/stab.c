@@ -0,0 +1,214 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stab.h"							//we estimate frequency stability
+
+//vector kernels the compiler targets
+#if defined(__AVX2__) && defined(__FMA__)
+#define STAB_AVX2			1
+#include <immintrin.h>
+#else
+#define STAB_AVX2			0
+#endif
+#if !STAB_AVX2 && defined(__ARM_NEON) && defined(__aarch64__)
+#define STAB_NEON			1
+#include <arm_neon.h>
+#else
+#define STAB_NEON			0
+#endif
+
+void stab_init(STAB_TypeDef *s, double tau0) {
+	memset(s, 0, sizeof(*s));
+	s->tau0 = tau0;
+}
+
+//a block of octave k is complete: its phase sum b, and the phase x0 at its start
+//the second differences of the block starts give ADEV, of the block sums MDEV. pairs of blocks make the next octave's
+static void blk(STAB_TypeDef *s, uint8_t k, double b, double x0) {
+	STAB_OctTypeDef *o;
+	double d;
+
+	for (; k < STAB_OCT; k++) {
+		o = &s->oct[k];
+		if (o->nb == 2) {
+			d = x0 - 2 * o->x[0] + o->x[1];
+			o->sa += d * d;
+			d = b - 2 * o->b[0] + o->b[1];
+			o->sm += d * d;
+			o->n += 1;
+		} else o->nb += 1;
+		o->x[1] = o->x[0]; o->x[0] = x0;
+		o->b[1] = o->b[0]; o->b[0] = b;
+		if (!o->pend) {
+			o->pend = 1;
+			o->pend_x = x0;
+			o->pend_b = b;
+			return;
+		}
+		o->pend = 0;
+		b += o->pend_b;
+		x0 = o->pend_x;
+	}
+}
+
+void stab_add(STAB_TypeDef *s, double x) {
+	s->n += 1;
+	blk(s, 0, x, x);
+}
+
+uint64_t stab_get(const STAB_TypeDef *s, uint8_t k, double *tau, double *adev, double *mdev, double *tdev) {
+	const STAB_OctTypeDef *o;
+	double m = ldexp(1, k), t = m * s->tau0;
+
+	*tau = t;
+	*adev = *mdev = *tdev = 0;
+	if ((k >= STAB_OCT) || !(o = &s->oct[k])->n) return 0;
+	*adev = sqrt(o->sa / (2 * t * t * o->n));
+	*mdev = sqrt(o->sm / (2 * m * m * t * t * o->n));
+	*tdev = t / sqrt(3) * *mdev;
+	return o->n;
+}
+
+#if STAB_AVX2
+const char *stab_isa = "avx2";
+#elif STAB_NEON
+const char *stab_isa = "neon";
+#else
+const char *stab_isa = "scalar";
+#endif
+uint8_t stab_simd = 1;
+
+//sum over i < n of (a[i] + w1 * b[i] + w2 * c[i] + w3 * d[i])^2
+//ADEV: x at i, i + m, i + 2m with 1, -2, 1. MDEV: the prefix sum at i .. i + 3m with -1, 3, -3, 1
+static double k_scalar(const double *a, const double *b, const double *c, const double *d, double w1, double w2, double w3, uint64_t n) {
+	double s0 = 0, s1 = 0, t;
+	uint64_t i;
+
+	for (i = 0; i + 1 < n; i += 2) {		//two chains, so the adds overlap
+		t = a[i] + w1 * b[i] + w2 * c[i] + w3 * d[i]; s0 += t * t;
+		t = a[i + 1] + w1 * b[i + 1] + w2 * c[i + 1] + w3 * d[i + 1]; s1 += t * t;
+	}
+	if (i < n) {t = a[i] + w1 * b[i] + w2 * c[i] + w3 * d[i]; s0 += t * t;}
+	return s0 + s1;
+}
+
+static double k_simd(const double *a, const double *b, const double *c, const double *d, double w1, double w2, double w3, uint64_t n) {
+#if STAB_AVX2
+	__m256d v1 = _mm256_set1_pd(w1), v2 = _mm256_set1_pd(w2), v3 = _mm256_set1_pd(w3);
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(), t0, t1;
+	double r[4];
+	uint64_t i;
+
+	for (i = 0; i + 8 <= n; i += 8) {		//two vectors of 4, two chains
+		t0 = _mm256_fmadd_pd(v3, _mm256_loadu_pd(d + i), _mm256_fmadd_pd(v2, _mm256_loadu_pd(c + i),
+			_mm256_fmadd_pd(v1, _mm256_loadu_pd(b + i), _mm256_loadu_pd(a + i))));
+		t1 = _mm256_fmadd_pd(v3, _mm256_loadu_pd(d + i + 4), _mm256_fmadd_pd(v2, _mm256_loadu_pd(c + i + 4),
+			_mm256_fmadd_pd(v1, _mm256_loadu_pd(b + i + 4), _mm256_loadu_pd(a + i + 4))));
+		s0 = _mm256_fmadd_pd(t0, t0, s0);
+		s1 = _mm256_fmadd_pd(t1, t1, s1);
+	}
+	_mm256_storeu_pd(r, _mm256_add_pd(s0, s1));
+	return r[0] + r[1] + r[2] + r[3] + k_scalar(a + i, b + i, c + i, d + i, w1, w2, w3, n - i);
+#elif STAB_NEON
+	float64x2_t s0 = vdupq_n_f64(0), s1 = vdupq_n_f64(0), t0, t1;
+	uint64_t i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		t0 = vfmaq_n_f64(vfmaq_n_f64(vfmaq_n_f64(vld1q_f64(a + i), vld1q_f64(b + i), w1), vld1q_f64(c + i), w2), vld1q_f64(d + i), w3);
+		t1 = vfmaq_n_f64(vfmaq_n_f64(vfmaq_n_f64(vld1q_f64(a + i + 2), vld1q_f64(b + i + 2), w1), vld1q_f64(c + i + 2), w2),
+			vld1q_f64(d + i + 2), w3);
+		s0 = vfmaq_f64(s0, t0, t0);
+		s1 = vfmaq_f64(s1, t1, t1);
+	}
+	return vaddvq_f64(vaddq_f64(s0, s1)) + k_scalar(a + i, b + i, c + i, d + i, w1, w2, w3, n - i);
+#else
+	return k_scalar(a, b, c, d, w1, w2, w3, n);
+#endif
+}
+
+void stab_prefix(const double *x, uint64_t n, double *sum) {
+	double s = 0, x0 = n ? x[0] : 0, b = (n > 1) ? (x[n - 1] - x0) / (n - 1) : 0;
+	uint64_t i;
+
+	sum[0] = 0;
+	for (i = 0; i < n; i++) sum[i + 1] = s += x[i] - x0 - b * i;
+}
+
+uint64_t stab_ovl(const double *x, const double *sum, uint64_t n, uint64_t m, double tau0, double *adev, double *mdev, double *tdev) {
+	double (*k)(const double *, const double *, const double *, const double *, double, double, double, uint64_t);
+	double t = m * tau0, dm = (double) m;
+
+	k = stab_simd ? k_simd : k_scalar;
+	*adev = *mdev = *tdev = 0;
+	if (!m || (n < 2 * m + 1)) return 0;
+	//ADEV: x[i + 2m] - 2 x[i + m] + x[i]. the zero weight reuses x
+	*adev = sqrt(k(x, x + m, x + 2 * m, x, -2, 1, 0, n - 2 * m) / (2 * t * t * (n - 2 * m)));
+	//MDEV: the block sums of m phase samples, second differenced: sum[i + 3m] - 3 sum[i + 2m] + 3 sum[i + m] - sum[i]
+	if (sum && (n >= 3 * m)) {
+		*mdev = sqrt(k(sum + 3 * m, sum + 2 * m, sum + m, sum, -3, 3, -1, n - 3 * m + 1) / (2 * dm * dm * t * t * (n - 3 * m + 1)));
+		*tdev = t / sqrt(3) * *mdev;
+	}
+	return n - 2 * m;
+}
+
+uint64_t stab_mtie(const double *x, uint64_t n, uint64_t m, double *mtie) {
+	uint64_t *qmax, *qmin, hmax = 0, tmax = 0, hmin = 0, tmin = 0, i, sz = m + 1;
+	double r;
+
+	*mtie = 0;
+	if (!m || (n < m + 1)) return 0;
+	//ring buffers of indices: a window holds at most m + 1 candidates
+	if (!(qmax = malloc(2 * sz * sizeof(uint64_t)))) return 0;
+	qmin = qmax + sz;
+	for (i = 0; i < n; i++) {
+		//drop candidates that can no longer be the extreme of a window holding x[i], and the ones that left [i - m, i]
+		while ((tmax != hmax) && (x[qmax[(tmax - 1) % sz]] <= x[i])) tmax--;
+		if ((tmax != hmax) && (qmax[hmax % sz] + m < i)) hmax++;
+		qmax[tmax++ % sz] = i;
+		while ((tmin != hmin) && (x[qmin[(tmin - 1) % sz]] >= x[i])) tmin--;
+		if ((tmin != hmin) && (qmin[hmin % sz] + m < i)) hmin++;
+		qmin[tmin++ % sz] = i;
+		if ((i >= m) && ((r = x[qmax[hmax % sz]] - x[qmin[hmin % sz]]) > *mtie)) *mtie = r;
+	}
+	free(qmax);
+	return n - m;
+}
+
+//MTIE masks. the recommendations' segments, in seconds
+const STAB_MaskTypeDef stab_masks[] = {
+	{"g811", "G.811 primary reference clock", {
+		{0.1, 1000, 25e-9, 0.275e-9, 1},
+		{1000, 1e12, 290e-9, 0.01e-9, 1}}},
+	{"prtc-a", "G.8272 PRTC-A, gnss locked", {
+		{0.1, 273, 25e-9, 0.275e-9, 1},
+		{273, 1e12, 100e-9, 0, 0}}},
+	{"g8262", "G.8262 EEC option 1, constant temperature wander", {
+		{0.1, 1, 40e-9, 0, 0},
+		{1, 100, 0, 40e-9, 0.1},
+		{100, 1000, 0, 25.25e-9, 0.2}}},
+	{NULL, NULL, {{0, 0, 0, 0, 0}}}
+};
+
+//a flat limit, for a design whose phase moves in steps: the same at every tau
+static STAB_MaskTypeDef _flat = {"flat", "flat limit, seconds", {{0.1, 1e12, 0, 0, 0}}};
+
+const STAB_MaskTypeDef *stab_mask(const char *name) {
+	const STAB_MaskTypeDef *k;
+	char *end;
+	double lim;
+
+	for (k = stab_masks; k->name; k++) if (!strcmp(k->name, name)) return k;
+	lim = strtod(name, &end);
+	if ((end == name) || *end || !(lim > 0)) return NULL;
+	_flat.name = name;
+	_flat.seg[0].a = lim;
+	return &_flat;
+}
+
+double stab_mask_lim(const STAB_MaskTypeDef *mask, double tau) {
+	uint8_t i;
+
+	for (i = 0; (i < STAB_SEGS) && mask->seg[i].hi; i++)
+		if ((tau > mask->seg[i].lo) && (tau <= mask->seg[i].hi)) return mask->seg[i].a + mask->seg[i].b * pow(tau, mask->seg[i].e);
+	return 0;
+}
@@ -0,0 +1,73 @@
+#ifndef _STAB_H
+#define _STAB_H
+//header file for the frequency stability estimators
+//allan (ADEV), modified allan (MDEV) and time (TDEV) deviation of a phase record, at octave spaced tau = 2^k * tau0,
+//in a single streaming pass: each octave keeps two phase samples and two block sums, so memory is O(log N)
+//the streaming estimators are the non-overlapped ones - adjacent averages at each tau, stepping by tau
+//the fully overlapped ones (stab_ovl) need the whole record in memory: O(N) per tau from a prefix sum of the phase,
+//with AVX2 / NEON kernels when the compiler targets them (-march=native) and a scalar loop otherwise
+
+#include <stdint.h>
+
+//configuration
+#define STAB_OCT			40				//octaves: tau up to 2^39 * tau0
+//end configuration
+
+//one octave, tau = m * tau0 with m = 2^k
+typedef struct {
+	double x[2];							//phase at the start of the last two blocks, newest first
+	double b[2];							//sums of the last two blocks, newest first
+	uint8_t nb;								//blocks seen, up to 2
+	double pend_x, pend_b;					//first block of the pair that makes the next octave's block
+	uint8_t pend;
+	double sa, sm;							//sums of the squared second differences: phase, block sums
+	uint64_t n;								//second differences summed
+} STAB_OctTypeDef;
+
+//estimator state
+typedef struct {
+	double tau0;							//sample interval, seconds
+	uint64_t n;								//phase samples
+	STAB_OctTypeDef oct[STAB_OCT];
+} STAB_TypeDef;
+
+//start: sample interval in seconds
+void stab_init(STAB_TypeDef *s, double tau0);
+//add the next phase (time error) sample, seconds
+void stab_add(STAB_TypeDef *s, double x);
+
+//octave k: tau in seconds, and ADEV / MDEV / TDEV. returns the number of terms, 0 when the record is too short
+uint64_t stab_get(const STAB_TypeDef *s, uint8_t k, double *tau, double *adev, double *mdev, double *tdev);
+
+//fully overlapped estimators, over a whole phase record x[0..n)
+//prefix sum for MDEV / TDEV: sum[0..n] - the line through the end points is taken out first, which the second
+//differences ignore, to keep the sums small and exact
+void stab_prefix(const double *x, uint64_t n, double *sum);
+//tau = m * tau0: ADEV, and MDEV / TDEV when sum is given. returns the number of ADEV terms, 0 when n is too short
+uint64_t stab_ovl(const double *x, const double *sum, uint64_t n, uint64_t m, double tau0, double *adev, double *mdev, double *tdev);
+
+//MTIE over windows of m intervals (m + 1 samples): the largest peak to peak phase in any of them
+//O(N) for each m, with monotonic deques of the candidate maxima and minima. returns the windows, 0 when n is too short
+uint64_t stab_mtie(const double *x, uint64_t n, uint64_t m, double *mtie);
+
+//MTIE masks: segments lo < tau <= hi with limit = a + b * tau^e, seconds
+#define STAB_SEGS			4
+typedef struct {
+	const char *name;
+	const char *desc;
+	struct {
+		double lo, hi, a, b, e;
+	} seg[STAB_SEGS];						//hi = 0 ends the list
+} STAB_MaskTypeDef;
+
+extern const STAB_MaskTypeDef stab_masks[];	//ends with a NULL name
+//mask by name (g811 / prtc-a / g8262), a flat limit in seconds (e.g. 6.6e-6: the same at every tau), or NULL
+const STAB_MaskTypeDef *stab_mask(const char *name);
+//limit at tau, or 0 outside the mask
+double stab_mask_lim(const STAB_MaskTypeDef *mask, double tau);
+
+//vector kernels: 1 (default) to use them, 0 for the scalar loop. and the instruction set they use
+extern uint8_t stab_simd;
+extern const char *stab_isa;
+
+#endif
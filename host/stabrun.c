@@ -0,0 +1,243 @@
+//stabrun: ADEV / MDEV / TDEV of a pps edge log, in one streaming pass or fully overlapped, or its phase noise spectrum
+//
+//build:	cc -O2 -march=native -o stabrun stabrun.c stab.c psd.c trace.c -lm	(-march=native: the AVX2 / NEON kernels for -o / -s)
+//usage:	stabrun [-t tau0] [-p] [-o] [-b] [-m mask] [-s len [-c nu0]] [-w first[:last]] [log|-]
+//	log: one edge per line, "t" or "n t" - t the edge time in seconds, n its second (or sample) number.
+//	     avrrun -l writes this, and so do most counter logs. lines that do not start with a number are skipped
+//	     or a binary trace (avrrun -L, trace.c): it is mapped rather than read, and -w seeks straight to its window
+//	-t: nominal interval between edges, seconds. default 1
+//	-p: the values are already phase (time error, seconds) rather than edge times. text logs only
+//	-o: fully overlapped estimators instead: the record is held in memory (16 bytes a sample)
+//	-b: time the streaming pass against the overlapped estimators, scalar and vector, on this record
+//	-m: also TIE and MTIE, checked against a mask: g811, prtc-a (gnss locked), g8262 (see stab.c) or a flat limit in
+//	    seconds, e.g. 6.6e-6 for a design that steers in timer ticks. exit 1 on a failure
+//	-s: instead, the welch phase noise spectrum over segments of len samples (a power of 2): columns f, S_x, S_y, L(f),
+//	    # comments above them - gnuplot: set logscale x; plot 'spec' using 1:4 with lines
+//	-c: carrier frequency L(f) is referred to, Hz. default 10e6
+//	-w: only the edges numbered first to last, e.g. -w 200 to drop the discipline loop pulling in
+//
+//the phase is x = t - t_first - n * tau0. a gap in n (a dropped pulse) is bridged by interpolating the phase
+//without -o / -b / -m / -s memory does not grow with the log: multi-week captures stream through
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "stab.h"							//we estimate stability
+#include "psd.h"							//and phase noise
+#include "trace.h"							//we read edge traces
+
+#ifndef M_PI
+#define M_PI				3.14159265358979323846
+#endif
+
+static STAB_TypeDef st;
+
+//the record, for -o / -b / -m / -s
+static double *rec;
+static uint64_t rec_n, rec_max;
+
+//next phase sample
+static void add(double x, uint8_t keep) {
+	stab_add(&st, x);
+	if (!keep) return;
+	if (rec_n == rec_max) {
+		rec_max = rec_max ? 2 * rec_max : 65536;
+		if (!(rec = realloc(rec, rec_max * sizeof(double)))) {
+			fprintf(stderr, "stabrun: out of memory at %llu samples\n", (unsigned long long) rec_n);
+			exit(2);
+		}
+	}
+	rec[rec_n++] = x;
+}
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//all octaves, fully overlapped. returns the largest relative difference to ref[] (ADEV, MDEV per octave) if given
+static double ovl(double *sum, double tau0, uint8_t print, const double *ref, double *out) {
+	double adev, mdev, tdev, d, worst = 0;
+	uint64_t m, terms;
+	uint8_t k;
+
+	stab_prefix(rec, rec_n, sum);
+	for (k = 0, m = 1; (terms = stab_ovl(rec, sum, rec_n, m, tau0, &adev, &mdev, &tdev)); k++, m *= 2) {
+		if (print) printf("%14g %10llu %12.4e %12.4e %12.4e\n", m * tau0, (unsigned long long) terms, adev, mdev, tdev);
+		if (out) {out[2 * k] = adev; out[2 * k + 1] = mdev;}
+		if (ref && ref[2 * k] && ((d = fabs(adev / ref[2 * k] - 1)) > worst)) worst = d;
+		if (ref && ref[2 * k + 1] && ((d = fabs(mdev / ref[2 * k + 1] - 1)) > worst)) worst = d;
+	}
+	return worst;
+}
+
+int main(int argc, char **argv) {
+	double tau0 = 1, v[2], t0 = 0, x, xl = 0, tau, adev, mdev, tdev;
+	uint8_t phase = 0, full = 0, bench = 0, fail = 0, k;
+	const STAB_MaskTypeDef *mask = NULL;
+	double lim, mtie, tie_max = 0, tie_sq = 0;
+	uint64_t m;
+	double *sum, t, ref[2 * 64], diff;
+	const char *path = NULL;
+	FILE *fp = stdin;
+	char line[256];
+	uint64_t n = 0, n0 = 0, nl = 0, nx, i, fill = 0, terms, segs;
+	uint32_t len = 0, j;
+	double nu0 = 10e6, *sx, f;
+	unsigned long long w_first = 0, w_last = UINT64_MAX;
+	TRC_ReaderTypeDef tr, peek;
+	uint64_t tn, tt, tb = 0;
+	int a, c;
+
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-t") && (a + 1 < argc)) tau0 = atof(argv[++a]);
+		else if (!strcmp(argv[a], "-p")) phase = 1;
+		else if (!strcmp(argv[a], "-o")) full = 1;
+		else if (!strcmp(argv[a], "-b")) bench = 1;
+		else if (!strcmp(argv[a], "-m") && (a + 1 < argc)) {
+			if (!(mask = stab_mask(argv[++a]))) tau0 = 0;
+		}
+		else if (!strcmp(argv[a], "-s") && (a + 1 < argc)) {
+			len = atoi(argv[++a]);
+			if ((len < 4) || (len & (len - 1))) tau0 = 0;
+		}
+		else if (!strcmp(argv[a], "-c") && (a + 1 < argc)) nu0 = atof(argv[++a]);
+		else if (!strcmp(argv[a], "-w") && (a + 1 < argc)) sscanf(argv[++a], "%llu:%llu", &w_first, &w_last);
+		else path = argv[a];
+	}
+	if (tau0 <= 0) {
+		fprintf(stderr, "usage: stabrun [-t tau0] [-p] [-o] [-b] [-m mask] [-s len [-c nu0]] [-w first[:last]] [log|-]\n");
+		for (mask = stab_masks; mask->name; mask++) fprintf(stderr, "\t%-8s %s\n", mask->name, mask->desc);
+		fprintf(stderr, "\t%-8s %s\n", "<s>", "flat limit, seconds");
+		return 2;
+	}
+	memset(&tr, 0, sizeof(tr));
+	if (path && trc_is(path)) {
+		if (trc_open(&tr, path)) {
+			fprintf(stderr, "stabrun: cannot map %s\n", path);
+			return 2;
+		}
+		trc_seek(&tr, w_first);
+		peek = tr;
+		trc_next(&peek, &tn, &tb);			//times from the first edge, in ticks: exact however long the trace
+	}
+	else if (path && strcmp(path, "-") && !(fp = fopen(path, "r"))) {
+		fprintf(stderr, "stabrun: cannot open %s\n", path);
+		return 2;
+	}
+
+	stab_init(&st, tau0);
+	for (;;) {
+		if (tr.map) {
+			if (!trc_next(&tr, &tn, &tt)) break;
+			c = 2;
+			v[0] = tn;
+			v[1] = (double) (tt - tb) / tr.hz;
+		}
+		else if (!fgets(line, sizeof(line), fp)) break;
+		else if ((c = sscanf(line, "%lf %lf", &v[0], &v[1])) < 1) continue;
+		nx = (c == 2) ? (uint64_t) v[0] : nl;
+		nl += 1;
+		if (nx < w_first) continue;
+		if (nx > w_last) break;
+		if (c == 1) v[1] = v[0];
+		if (!st.n) {t0 = phase ? 0 : v[1]; n0 = nx;}
+		else if (nx <= n) continue;				//repeated or out of order
+		x = phase ? v[1] : v[1] - t0 - (nx - n0) * tau0;
+		for (i = n + 1; st.n && (i < nx); i++) {		//bridge a gap
+			add(xl + (x - xl) * (i - n) / (nx - n), full | bench | !!mask | !!len);
+			fill += 1;
+		}
+		add(x, full | bench | !!mask | !!len);
+		n = nx;
+		xl = x;
+	}
+	if (tr.map) trc_done(&tr);
+	else if (fp != stdin) fclose(fp);
+
+	if (len) {
+		if (!(sx = malloc((len / 2 + 1) * sizeof(double)))) return 2;
+		if (!(segs = psd_welch(rec, rec_n, len, tau0, sx))) {
+			fprintf(stderr, "stabrun: %llu phase samples, fewer than a segment of %u\n", (unsigned long long) rec_n, len);
+			return 2;
+		}
+		printf("# %llu phase samples at tau0 = %gs, %llu bridged\n", (unsigned long long) rec_n, tau0, (unsigned long long) fill);
+		printf("# welch: %llu hann segments of %u, half overlapped, %s fft. L(f) for a %g Hz carrier\n", (unsigned long long) segs, len, psd_isa, nu0);
+		printf("# %12s %12s %12s %12s\n", "f Hz", "S_x s^2/Hz", "S_y 1/Hz", "L(f) dBc/Hz");
+		for (j = 1; j <= len / 2; j++) {			//dc is the detrended mean: nothing to plot
+			f = j / (len * tau0);
+			printf("  %12.6e %12.4e %12.4e %12.2f\n", f, sx[j], 4 * M_PI * M_PI * f * f * sx[j],
+				10 * log10(2 * M_PI * M_PI * nu0 * nu0 * sx[j] + 1e-300));
+		}
+		free(sx);
+		free(rec);
+		return 0;
+	}
+
+	printf("%llu phase samples at tau0 = %gs, %llu bridged\n\n", (unsigned long long) st.n, tau0, (unsigned long long) fill);
+	printf("%14s %10s %12s %12s %12s%s\n", "tau s", "terms", "adev", "mdev", "tdev s", full ? "   (fully overlapped)" : "");
+	if (!(sum = (full | bench) ? malloc((rec_n + 1) * sizeof(double)) : NULL) && (full | bench)) {
+		fprintf(stderr, "stabrun: out of memory\n");
+		return 2;
+	}
+	if (full) ovl(sum, tau0, 1, NULL, NULL);
+	else for (k = 0; k < STAB_OCT; k++) {
+		if (!(terms = stab_get(&st, k, &tau, &adev, &mdev, &tdev))) break;
+		printf("%14g %10llu %12.4e %12.4e %12.4e\n", tau, (unsigned long long) terms, adev, mdev, tdev);
+	}
+
+	if (bench) {
+		printf("\n%llu samples, all octaves:\n", (unsigned long long) rec_n);
+		t = now();
+		stab_init(&st, tau0);
+		for (i = 0; i < rec_n; i++) stab_add(&st, rec[i]);
+		printf("  streaming, non-overlapped       %9.3fs\n", now() - t);
+		memset(ref, 0, sizeof(ref));
+		stab_simd = 0;
+		t = now();
+		ovl(sum, tau0, 0, NULL, ref);
+		printf("  overlapped, prefix sum, scalar  %9.3fs\n", now() - t);
+		stab_simd = 1;
+		t = now();
+		diff = ovl(sum, tau0, 0, ref, NULL);
+		printf("  overlapped, prefix sum, %-6s  %9.3fs   (%.1e from scalar)\n", stab_isa, now() - t, diff);
+		for (j = 4096; j > rec_n; j /= 2) ;
+		if ((j >= 4) && (sx = malloc((j + 2) * sizeof(double)))) {
+			psd_simd = 0;
+			t = now();
+			psd_welch(rec, rec_n, j, tau0, sx);
+			printf("  welch, segments of %-4u scalar  %9.3fs\n", j, now() - t);
+			psd_simd = 1;
+			t = now();
+			psd_welch(rec, rec_n, j, tau0, sx + j / 2);
+			printf("  welch, segments of %-4u %-6s  %9.3fs\n", j, psd_isa, now() - t);
+			free(sx);
+		}
+	}
+
+	if (mask) {
+		//TIE against the first edge
+		for (i = 0; i < rec_n; i++) {
+			tie_sq += (rec[i] - rec[0]) * (rec[i] - rec[0]);
+			if (fabs(rec[i] - rec[0]) > tie_max) tie_max = fabs(rec[i] - rec[0]);
+		}
+		printf("\nTIE: %.1fns rms, %.1fns worst\n", rec_n ? sqrt(tie_sq / rec_n) * 1e9 : 0, tie_max * 1e9);
+		printf("MTIE against %s (%s)\n", mask->name, mask->desc);
+		printf("%14s %10s %12s %12s\n", "tau s", "windows", "mtie s", "limit s");
+		for (m = 1; (terms = stab_mtie(rec, rec_n, m, &mtie)); m *= 2) {
+			lim = stab_mask_lim(mask, m * tau0);
+			printf("%14g %10llu %12.4e ", m * tau0, (unsigned long long) terms, mtie);
+			if (lim) printf("%12.4e %s\n", lim, (mtie > lim) ? "FAIL" : "pass");
+			else printf("%12s\n", "-");
+			if (lim && (mtie > lim)) fail = 1;
+		}
+		printf("mtie %s: %s\n", mask->name, fail ? "FAIL" : "PASS");
+	}
+	free(sum);
+	free(rec);
+	return fail;
+}
@@ -0,0 +1,43 @@
+#!/bin/sh
+#stress: 1pps edge jitter of each engine mode under competing interrupt loads
+#
+#usage:	host/stress.sh
+#	builds the firmware with avr-gcc in each PPS_MODE - software edge (PPS_ISR), hardware compare (PPS_HWOC, on OC0B)
+#	and polled (PPS_POLL) - for the first frequency plan in matrix.sh with the PPS_SRAM:1:REF_NONE feature set, runs
+#	it in avrrun with no load, a soft uart, and every load avrrun -i has, and prints the cycles the edges stray off
+#	a straight line through them: p50, p99, p99.9 and peak to peak, with the load requests lost to overrun
+#
+#environment: CC (avr-gcc), MCU (attiny85), HOSTCC (cc), STRESS_SECS (emulated seconds, 300), STRESS_PLAN (the
+#	first of PLANS), STRESS_FEAT (PPS_SRAM:1:REF_NONE)
+
+set -e
+cd "$(dirname "$0")/.."
+. host/matrix.sh							#PLANS, FEATS, fw_build
+HOSTCC=${HOSTCC:-cc}
+SECS=${STRESS_SECS:-300}
+PLAN=${STRESS_PLAN:-${PLANS%% *}}
+FEAT=${STRESS_FEAT:-PPS_SRAM:1:REF_NONE}
+OUT=${TMPDIR:-/tmp}/stress.$$
+mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+
+$HOSTCC -O2 -o "$OUT/avrrun" host/avrrun.c host/avrsim.c host/osc.c host/gps.c host/trace.c host/golden.c host/vcd.c -lm
+echo "$PLAN/$FEAT, $SECS emulated seconds, jitter in cycles off a straight line through the edges"
+printf "%-9s %-24s %7s %8s %8s %8s %8s %6s\n" "mode" "load" "edges" "p50" "p99" "p99.9" "p-p" "lost"
+#mode:flags:edge pin
+for m in "PPS_ISR::2" "PPS_HWOC:-DPPS_PIN=(1<<1):1" "PPS_POLL::2"; do
+	mode=${m%%:*}; pin=${m##*:}; extra=${m#*:}; extra=${extra%:*}
+	FW_FLAGS="-DPPS_MODE=$mode $extra" fw_build $PLAN $FEAT "$OUT/fw.elf"
+	for l in "" "-i uart" "-i uart -i pcint -i adc -i usi"; do
+		line=$("$OUT/avrrun" -p $MCU -f $F_CPU -t $SECS -e $pin ${l:--i none} -r "$OUT/fw.elf")
+		echo "$line" | awk -v m=$mode -v l="${l:-none}" '{
+			for (i = 1; i <= NF; i++) {
+				split($i, g, ":")
+				if (g[1] == "jit") {n = g[2]; p50 = g[3]; p99 = g[4]; p999 = g[5]; pp = g[6]}
+				if (g[1] == "load") lost += g[4]
+			}
+			gsub(/-i /, "", l)
+			printf "%-9s %-24s %7s %8s %8s %8s %8s %6u\n", m, l, n, p50, p99, p999, pp, lost
+		}'
+	done
+done
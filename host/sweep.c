@@ -0,0 +1,338 @@
+//sweep: build and run every frequency plan x feature set on all cores, and report edge error, cpu load and footprint
+//
+//build:	cc -O2 -pthread -o sweep sweep.c
+//usage:	sweep [-j jobs] [-t seconds] [-m] [-P file] [-a avrrun] [-s seed] [-r] [-k dir]
+//	run from the repository root (sweep.sh does this): each combination is built with fw_build from host/matrix.sh,
+//	sized with avr-size and run in avrrun against an oscillator model and a gps reference
+//	-j: worker threads. default: one per online cpu
+//	-t: emulated seconds a run. default 20 (edge error over the second half, see avrrun -g)
+//	-m: also every timer0 plan in the example table in main.c ("24,00Mhz = 8 * 8 * 250 * 1500"). F_OSC is the product,
+//	    and an example whose product is not its frequency is reported on stderr and skipped
+//	-P: also the plans in file ('-': stdin), one F_OSC:PS_FUSE:PS_TMR:TMR_TOP:ISR_CNT a line - the format of PLANS, and
+//	    what a plan search can print. lines starting with '#' are skipped
+//	-a: the avrrun to use. default ./avrrun
+//	-s: seed of the oscillator and gps models. default 1
+//	-r: one machine readable line a combination instead of the table: plan/features then avrrun -r's tokens,
+//	    and size:<flash>:<sram>
+//	-k: work directory, kept afterwards. default a temporary one, removed
+//
+//combinations are dealt to the workers in runs, each worker taking from the front of its own and, once that is empty,
+//stealing from the back of the fullest other: plans differ by 10x in isr rate, so a fixed split leaves cores idle
+//exit 1 when a combination fails to build or to run
+//environment: as matrix.sh (CC, MCU, FW_FLAGS), SIZE (avr-size)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+
+//configuration
+#define SW_JOBS				1024			//most combinations
+#define SW_THREADS			256				//most workers
+#define SW_LINE				4096			//longest line read
+//end configuration
+
+//one plan x feature set, and what it came out as
+typedef struct {
+	char plan[64], feat[64];
+	char raw[SW_LINE];						//avrrun -r tokens
+	uint8_t fail;							//0 ok, 1 build, 2 run
+	unsigned long flash, sram;
+	double isr_max, load, edge_max;			//worst isr, cycles; cpu load, %; edge latency bound, cycles
+	double rms, worst;						//edge against true seconds, ns
+	double secs;							//wall time
+} SW_JobTypeDef;
+
+//a worker's run of jobs: it takes from head, thieves from tail
+typedef struct {
+	pthread_mutex_t mx;
+	int head, tail;							//jobs head..tail-1 left
+	pthread_t th;
+	int id;
+} SW_DequeTypeDef;
+
+static SW_JobTypeDef job[SW_JOBS];
+static int njob;
+static SW_DequeTypeDef dq[SW_THREADS];
+static int nthr;
+static pthread_mutex_t out_mx = PTHREAD_MUTEX_INITIALIZER;
+static int done, steals;
+
+static const char *avrrun = "./avrrun", *work;
+static double secs = 20;
+static unsigned long seed = 1;
+
+static double now(void) {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void add(const char *plan, const char *feat) {
+	int i;
+
+	for (i = 0; i < njob; i++) if (!strcmp(job[i].plan, plan) && !strcmp(job[i].feat, feat)) return;	//listed twice
+	if (njob == SW_JOBS) return;
+	snprintf(job[njob].plan, sizeof(job[0].plan), "%s", plan);
+	snprintf(job[njob].feat, sizeof(job[0].feat), "%s", feat);
+	njob += 1;
+}
+
+//plans, features and the work directory go into a shell command unquoted: letters, digits, '_' and more only
+static int word(const char *s, const char *more) {
+	if (!*s) return 0;
+	for (; *s; s++) if (!isalnum((unsigned char) *s) && (*s != '_') && !strchr(more, *s)) return 0;
+	return 1;
+}
+
+//the plans of main.c's timer0 example table, as F_OSC:PS_FUSE:PS_TMR:TMR_TOP:ISR_CNT
+static int main_plans(char *plans, size_t len) {
+	FILE *fp = fopen("main.c", "r");
+	char s[256], p[64], fr[12] = "0.";
+	unsigned long f, a, b, c, d;
+	double mhz;
+	char *q;
+	int n = 0;
+
+	if (!fp) return -1;
+	*plans = 0;
+	while (fgets(s, sizeof(s), fp) && !strstr(s, "examples with a 16-bit timer1")) {
+		if (strncmp(s, "//", 2) || (sscanf(s + 2, " %lu,%9[0-9]Mhz", &a, fr + 2) != 2)) continue;
+		mhz = a + atof(fr);
+		if (!(q = strchr(s, '=')) || (sscanf(q + 1, " %lu * %lu * %lu * %lu", &a, &b, &c, &d) != 4)) continue;
+		f = a * b * c * d;
+		if ((f < mhz * 1e6 * 0.999) || (f > mhz * 1e6 * 1.001)) {
+			fprintf(stderr, "sweep: main.c example %.3fMhz = %lu * %lu * %lu * %lu is %luHz, skipped\n", mhz, a, b, c, d, f);
+			continue;
+		}
+		snprintf(p, sizeof(p), "%lu:%lu:%lu:%lu:%lu ", f, a, b, c, d);
+		if (strlen(plans) + strlen(p) < len) strcat(plans, p);
+		n += 1;
+	}
+	fclose(fp);
+	return n;
+}
+
+//one combination: build, size, run
+static void run(SW_JobTypeDef *j, int id) {
+	char cmd[1024], s[SW_LINE], *t, *sp;
+	unsigned long text, data, bss;
+	double t0 = now();
+	FILE *fp;
+	int st;
+
+	snprintf(cmd, sizeof(cmd), "set -e; . host/matrix.sh; d=%s/%d; mkdir -p $d;"
+		" fw_build %s %s $d/fw.elf > $d/build.log 2>&1 || exit 3;"
+		" ${SIZE:-avr-size} $d/fw.elf | tail -1;"
+		" %s -p $MCU -f $F_CPU -t %g -e 2 -s pps_out -o tcxo:%lu -g timing:%lu -r $d/fw.elf",
+		work, id, j->plan, j->feat, avrrun, secs, seed, seed);
+	j->fail = 2;
+	if (!(fp = popen(cmd, "r"))) return;
+	while (fgets(s, sizeof(s), fp)) {
+		if ((t = strchr(s, '\n'))) *t = 0;
+		if (sscanf(s, "%lu %lu %lu", &text, &data, &bss) == 3) {	//avr-size: text data bss dec hex filename
+			j->flash = text + data;
+			j->sram = data + bss;
+		}
+		else if (strstr(s, "isr:")) snprintf(j->raw, sizeof(j->raw), "%s", s);
+	}
+	st = pclose(fp);
+	j->fail = (WIFEXITED(st) && (WEXITSTATUS(st) == 3)) ? 1 : (st || !*j->raw) ? 2 : 0;
+	for (t = strtok_r(strcpy(s, j->raw), " ", &sp); t; t = strtok_r(NULL, " ", &sp)) {
+		char name[32];
+		double f[7];
+
+		//isr:<name>:<runs>:<min>:<avg>:<max>:<lat_max>:<load%>  edge:<runs>:<lat_min>:<lat_max>
+		//gps:<model>:<pulses>:<dropped>:<outliers>:<edges timed>:<mean, ns>:<rms, ns>:<max |error|, ns>
+		if (sscanf(t, "isr:%31[^:]:%lf:%lf:%lf:%lf:%lf:%lf", name, f, f + 1, f + 2, f + 3, f + 4, f + 5) == 7) {
+			if (f[3] > j->isr_max) j->isr_max = f[3];
+			j->load += f[5];
+		}
+		else if (sscanf(t, "edge:%lf:%lf:%lf", f, f + 1, f + 2) == 3) j->edge_max = f[2];
+		else if (sscanf(t, "gps:%31[^:]:%lf:%lf:%lf:%lf:%lf:%lf:%lf", name, f, f + 1, f + 2, f + 3, f + 4, f + 5, f + 6) == 8) {
+			j->rms = f[5];
+			j->worst = f[6];
+		}
+	}
+	j->secs = now() - t0;
+}
+
+//the next job for worker w: its own first, then the back of the fullest other. -1 when there are none left
+static int next(int w) {
+	int i, best, most, k = -1;
+
+	pthread_mutex_lock(&dq[w].mx);
+	if (dq[w].head < dq[w].tail) k = dq[w].head++;
+	pthread_mutex_unlock(&dq[w].mx);
+	while (k < 0) {
+		for (best = -1, most = 0, i = 0; i < nthr; i++) {
+			if (i == w) continue;
+			pthread_mutex_lock(&dq[i].mx);
+			if (dq[i].tail - dq[i].head > most) {
+				most = dq[i].tail - dq[i].head;
+				best = i;
+			}
+			pthread_mutex_unlock(&dq[i].mx);
+		}
+		if (best < 0) return -1;
+		pthread_mutex_lock(&dq[best].mx);
+		if (dq[best].head < dq[best].tail) k = --dq[best].tail;
+		pthread_mutex_unlock(&dq[best].mx);		//taken by another thief since: look again
+		if (k >= 0) {
+			pthread_mutex_lock(&out_mx);
+			steals += 1;
+			pthread_mutex_unlock(&out_mx);
+		}
+	}
+	return k;
+}
+
+static void *worker(void *arg) {
+	SW_DequeTypeDef *d = arg;
+	int k;
+
+	while ((k = next(d->id)) >= 0) {
+		run(&job[k], k);
+		pthread_mutex_lock(&out_mx);
+		done += 1;
+		fprintf(stderr, "[%d/%d] %s/%s %s, %.1fs\n", done, njob, job[k].plan, job[k].feat,
+			(job[k].fail == 1) ? "build failed" : job[k].fail ? "run failed" : "ok", job[k].secs);
+		pthread_mutex_unlock(&out_mx);
+	}
+	return NULL;
+}
+
+int main(int argc, char **argv) {
+	const char *pfile = NULL;
+	char plans[8192], feats[4096], fs[sizeof(feats)], s[256], key[160], tmp[64], *p, *f, *sp, *sf;
+	uint8_t raw = 0, mplans = 0, bad = 0, rm = 0;
+	double t0, cpu = 0;
+	FILE *fp;
+	int a, i;
+
+	for (a = 1; a < argc; a++) {
+		if (!strcmp(argv[a], "-j") && (a + 1 < argc)) nthr = atoi(argv[++a]);
+		else if (!strcmp(argv[a], "-t") && (a + 1 < argc)) secs = atof(argv[++a]);
+		else if (!strcmp(argv[a], "-m")) mplans = 1;
+		else if (!strcmp(argv[a], "-P") && (a + 1 < argc)) pfile = argv[++a];
+		else if (!strcmp(argv[a], "-a") && (a + 1 < argc)) avrrun = argv[++a];
+		else if (!strcmp(argv[a], "-s") && (a + 1 < argc)) seed = strtoul(argv[++a], NULL, 0);
+		else if (!strcmp(argv[a], "-r")) raw = 1;
+		else if (!strcmp(argv[a], "-k") && (a + 1 < argc)) work = argv[++a];
+		else nthr = -1;
+	}
+	if ((secs <= 0) || (nthr < 0) || (nthr > SW_THREADS)) {
+		fprintf(stderr, "usage: sweep [-j jobs] [-t seconds] [-m] [-P file] [-a avrrun] [-s seed] [-r] [-k dir]\n");
+		return 2;
+	}
+	if (!nthr && ((nthr = sysconf(_SC_NPROCESSORS_ONLN)) < 1)) nthr = 1;
+	if (nthr > SW_THREADS) nthr = SW_THREADS;
+
+	//PLANS and FEATS from matrix.sh, then the other plans
+	if (!(fp = popen(". host/matrix.sh && echo \"$PLANS\" && echo \"$FEATS\"", "r")) ||
+		!fgets(plans, sizeof(plans), fp) || !fgets(feats, sizeof(feats), fp)) {
+		fprintf(stderr, "sweep: cannot read host/matrix.sh (run from the repository root)\n");
+		return 2;
+	}
+	pclose(fp);
+	plans[strcspn(plans, "\n")] = ' ';
+	if (mplans && (main_plans(plans + strlen(plans), sizeof(plans) - strlen(plans)) <= 0)) {
+		fprintf(stderr, "sweep: no example plans in main.c\n");
+		return 2;
+	}
+	if (pfile) {
+		if (!(fp = strcmp(pfile, "-") ? fopen(pfile, "r") : stdin)) {
+			fprintf(stderr, "sweep: cannot read %s\n", pfile);
+			return 2;
+		}
+		while (fgets(s, sizeof(s), fp))
+			if ((s[0] != '#') && (sscanf(s, "%63s", tmp) == 1) && (strlen(plans) + strlen(tmp) + 2 < sizeof(plans))) {
+				strcat(plans, tmp);
+				strcat(plans, " ");
+			}
+		if (fp != stdin) fclose(fp);
+	}
+	for (p = strtok_r(plans, " \n", &sp); p; p = strtok_r(NULL, " \n", &sp)) {
+		if (!word(p, ":")) {
+			fprintf(stderr, "sweep: bad plan %s\n", p);
+			return 2;
+		}
+		snprintf(fs, sizeof(fs), "%s", feats);		//strtok_r cuts up its copy, a plan at a time
+		for (f = strtok_r(fs, " \n", &sf); f; f = strtok_r(NULL, " \n", &sf)) if (word(f, ":")) add(p, f);
+	}
+	if (!njob) {
+		fprintf(stderr, "sweep: nothing to run\n");
+		return 2;
+	}
+	if (nthr > njob) nthr = njob;
+
+	if (!work) {
+		snprintf(tmp, sizeof(tmp), "%s/sweep.XXXXXX", getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp");
+		if (!(work = mkdtemp(strdup(tmp)))) {
+			fprintf(stderr, "sweep: cannot make a work directory\n");
+			return 2;
+		}
+		rm = 1;									//remove it afterwards
+	}
+	if (!word(work, "/.-+")) {
+		fprintf(stderr, "sweep: work directory %s: letters, digits and _/.-+ only\n", work);
+		return 2;
+	}
+
+	//deal the jobs out in runs of consecutive ones: a run is one plan, so the slow plans spread over the workers
+	//only as far as the stealing spreads them
+	fprintf(stderr, "sweep: %d combinations on %d workers, %g emulated seconds each\n", njob, nthr, secs);
+	t0 = now();
+	for (i = 0; i < nthr; i++) {
+		pthread_mutex_init(&dq[i].mx, NULL);
+		dq[i].head = njob * i / nthr;
+		dq[i].tail = njob * (i + 1) / nthr;
+		dq[i].id = i;
+	}
+	for (i = 0; i < nthr; i++) pthread_create(&dq[i].th, NULL, worker, &dq[i]);
+	for (i = 0; i < nthr; i++) pthread_join(dq[i].th, NULL);
+	t0 = now() - t0;
+
+	if (!raw) printf("%-52s %6s %9s %7s %9s %9s %7s %6s\n", "plan/features", "isr", "edge lat", "load%",
+		"rms ns", "worst ns", "flash", "sram");
+	for (i = 0; i < njob; i++) {
+		SW_JobTypeDef *j = &job[i];
+
+		cpu += j->secs;
+		bad |= (j->fail != 0);
+		snprintf(key, sizeof(key), "%.63s/%.63s", j->plan, j->feat);
+		if (raw) printf("%s %s size:%lu:%lu%s\n", key, j->raw, j->flash, j->sram, j->fail ? " fail" : "");
+		else if (j->fail) printf("%-52s %s\n", key, (j->fail == 1) ? "build failed" : "run failed");
+		else printf("%-52s %6.0f %9.0f %7.3f %9.1f %9.1f %7lu %6lu\n", key, j->isr_max, j->edge_max, j->load,
+			j->rms, j->worst, j->flash, j->sram);
+	}
+	if (!raw) {
+		double lm = 0, wm = 0;
+		unsigned long fm = 0;
+		int kl = -1, kw = -1, kf = -1;
+
+		for (i = 0; i < njob; i++) {
+			if (job[i].fail) continue;
+			if (job[i].load > lm) {lm = job[i].load; kl = i;}
+			if (job[i].worst > wm) {wm = job[i].worst; kw = i;}
+			if (job[i].flash > fm) {fm = job[i].flash; kf = i;}
+		}
+		printf("\n");
+		if (kl >= 0) printf("most cpu:     %.3f%%  %s/%s\n", lm, job[kl].plan, job[kl].feat);
+		if (kw >= 0) printf("worst edge:   %.1fns  %s/%s\n", wm, job[kw].plan, job[kw].feat);
+		if (kf >= 0) printf("most flash:   %lu bytes  %s/%s\n", fm, job[kf].plan, job[kf].feat);
+		printf("%d combinations in %.1fs on %d workers (%.1fs of runs, %.1fx), %d stolen\n", njob, t0, nthr, cpu,
+			(t0 > 0) ? cpu / t0 : 0, steals);
+	}
+	if (rm) {
+		snprintf(s, sizeof(s), "rm -rf %s", work);
+		if (system(s)) fprintf(stderr, "sweep: cannot remove %s\n", work);
+	}
+	return bad;
+}
@@ -0,0 +1,22 @@
+#!/bin/sh
+#sweep: every frequency plan x feature set, built and run on all cores, in one report
+#
+#usage:	host/sweep.sh [sweep options]
+#	builds avrrun and sweep (sweep.c) with the host compiler and runs sweep from the repository root: the plans and
+#	feature sets of matrix.sh, -m to add every example plan in main.c, -P file to add a plan search's output.
+#	per combination: worst isr cycles, the edge latency bound, cpu load, the 1pps against true seconds with a tcxo
+#	and a timing gps (rms and worst, ns) and the flash / sram of the image
+#
+#exit 1 when a combination fails to build or to run
+#environment: CC (avr-gcc), MCU (attiny85), FW_FLAGS, SIZE (avr-size), HOSTCC (cc)
+
+set -e
+cd "$(dirname "$0")/.."
+HOSTCC=${HOSTCC:-cc}
+OUT=${TMPDIR:-/tmp}/sweep.$$
+mkdir -p "$OUT"
+trap 'rm -rf "$OUT"' EXIT
+
+$HOSTCC -O2 -o "$OUT/avrrun" host/avrrun.c host/avrsim.c host/osc.c host/gps.c host/trace.c host/golden.c host/vcd.c -lm
+$HOSTCC -O2 -pthread -o "$OUT/sweep" host/sweep.c
+"$OUT/sweep" -a "$OUT/avrrun" "$@"
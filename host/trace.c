@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"							//we read and write edge traces
+
+#define TRC_MAGIC			"PPSTRACE"
+#define TRC_VERSION			1
+
+static void put32(uint8_t *p, uint32_t v) {
+	uint8_t i;
+
+	for (i = 0; i < 4; i++) p[i] = v >> (8 * i);
+}
+
+static void put64(uint8_t *p, uint64_t v) {
+	uint8_t i;
+
+	for (i = 0; i < 8; i++) p[i] = v >> (8 * i);
+}
+
+static uint32_t get32(const uint8_t *p) {
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t get64(const uint8_t *p) {
+	return get32(p) | ((uint64_t) get32(p + 4) << 32);
+}
+
+//varint: 7 bits a byte, low first, top bit set on all but the last
+static uint32_t put_var(uint8_t *p, uint64_t v) {
+	uint32_t i = 0;
+
+	for (; v >= 0x80; v >>= 7) p[i++] = (v & 0x7f) | 0x80;
+	p[i++] = v;
+	return i;
+}
+
+static int get_var(const uint8_t *p, uint32_t *pos, uint32_t end, uint64_t *v) {
+	uint8_t sh;
+
+	for (*v = 0, sh = 0; (*pos < end) && (sh < 64); sh += 7) {
+		*v |= (uint64_t) (p[*pos] & 0x7f) << sh;
+		if (!(p[(*pos)++] & 0x80)) return 1;
+	}
+	return 0;
+}
+
+//writer
+static int header(TRC_WriterTypeDef *w) {
+	uint8_t h[TRC_HDR];
+
+	memset(h, 0, sizeof(h));
+	memcpy(h, TRC_MAGIC, 8);
+	put32(h + 8, TRC_VERSION);
+	put32(h + 12, TRC_BLOCK);
+	put64(h + 16, w->hz);
+	put64(h + 24, w->edges);
+	put64(h + 32, w->blocks);
+	put64(h + 40, w->n_first);
+	put64(h + 48, w->n_last);
+	return fwrite(h, 1, TRC_HDR, w->fp) != TRC_HDR;
+}
+
+int trc_create(TRC_WriterTypeDef *w, const char *path, uint64_t hz) {
+	memset(w, 0, sizeof(*w));
+	w->hz = hz ? hz : TRC_TICK;
+	if (!(w->fp = fopen(path, "wb"))) return 1;
+	return header(w);						//counts zero until trc_close
+}
+
+static int flush(TRC_WriterTypeDef *w) {
+	if (!w->count) return 0;
+	put32(w->blk + 24, w->count);
+	put32(w->blk + 28, w->used);
+	memset(w->blk + w->used, 0, TRC_BLOCK - w->used);
+	w->blocks += 1;
+	w->count = 0;
+	return fwrite(w->blk, 1, TRC_BLOCK, w->fp) != TRC_BLOCK;
+}
+
+int trc_add(TRC_WriterTypeDef *w, uint64_t n, uint64_t t) {
+	uint64_t dn = n - w->n_last, dt = t - w->t_last, d = 0;
+
+	if (w->edges && ((n <= w->n_last) || (t < w->t_last))) return 1;
+	if (w->count && (w->used + 20 > TRC_BLOCK) && flush(w)) return 1;	//room for two 10 byte varints
+	if (w->edges) {
+		d = dt - dn * w->per;
+		w->per = dt / dn;
+	}
+	if (!w->count) {						//new block: this edge in full
+		put64(w->blk, n);
+		put64(w->blk + 8, t);
+		put64(w->blk + 16, w->per);
+		w->used = TRC_BHDR;
+	}
+	else {
+		w->used += put_var(w->blk + w->used, dn - 1);
+		w->used += put_var(w->blk + w->used, (d << 1) ^ (uint64_t) ((int64_t) d >> 63));	//zigzag
+	}
+	if (!w->edges) w->n_first = n;
+	w->n_last = n;
+	w->t_last = t;
+	w->edges += 1;
+	w->count += 1;
+	return 0;
+}
+
+int trc_close(TRC_WriterTypeDef *w) {
+	int err;
+
+	err = flush(w);
+	err |= fseek(w->fp, 0, SEEK_SET) || header(w);
+	err |= fclose(w->fp);
+	w->fp = NULL;
+	return err;
+}
+
+//reader
+int trc_is(const char *path) {
+	char m[8];
+	FILE *fp;
+	int is;
+
+	if (!(fp = fopen(path, "rb"))) return 0;
+	is = (fread(m, 1, 8, fp) == 8) && !memcmp(m, TRC_MAGIC, 8);
+	fclose(fp);
+	return is;
+}
+
+//cursor on the first edge of block b. returns 0 past the last block
+static int load(TRC_ReaderTypeDef *r, uint64_t b) {
+	const uint8_t *p = r->map + TRC_HDR + b * TRC_BLOCK;
+
+	r->b = b;
+	r->pos = 0;
+	r->left = 0;
+	if (b >= r->blocks) return 0;
+	r->left = get32(p + 24);
+	r->end = get32(p + 28);
+	if ((r->end < TRC_BHDR) || (r->end > TRC_BLOCK)) r->left = 0;	//torn or damaged: skip it
+	return 1;
+}
+
+int trc_open(TRC_ReaderTypeDef *r, const char *path) {
+	struct stat st;
+	int fd;
+
+	memset(r, 0, sizeof(*r));
+	if ((fd = open(path, O_RDONLY)) < 0) return 1;
+	if (fstat(fd, &st) || (st.st_size < TRC_HDR)) {close(fd); return 1;}
+	r->size = st.st_size;
+	r->map = mmap(NULL, r->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (r->map == MAP_FAILED) {r->map = NULL; return 1;}
+	if (memcmp(r->map, TRC_MAGIC, 8) || (get32(r->map + 12) != TRC_BLOCK)) {trc_done(r); return 1;}
+	r->hz = get64(r->map + 16);
+	r->edges = get64(r->map + 24);
+	r->n_first = get64(r->map + 40);
+	r->n_last = get64(r->map + 48);
+	//blocks from the size, not the header: a trace whose writer died before trc_close still reads
+	r->blocks = (r->size - TRC_HDR) / TRC_BLOCK;
+	madvise((void *) r->map, r->size, MADV_SEQUENTIAL);
+	load(r, 0);
+	return 0;
+}
+
+int trc_next(TRC_ReaderTypeDef *r, uint64_t *n, uint64_t *t) {
+	const uint8_t *p;
+	uint64_t dn, z, dt;
+
+	while (!r->left)
+		if (!load(r, r->b + 1)) return 0;
+	p = r->map + TRC_HDR + r->b * TRC_BLOCK;
+	if (!r->pos) {
+		r->n = get64(p);
+		r->t = get64(p + 8);
+		r->per = get64(p + 16);
+		r->pos = TRC_BHDR;
+	}
+	else {
+		if (!get_var(p, &r->pos, r->end, &dn) || !get_var(p, &r->pos, r->end, &z)) {
+			r->left = 0;					//damaged: on to the next block
+			return trc_next(r, n, t);
+		}
+		dn += 1;
+		dt = dn * r->per + ((z >> 1) ^ -(z & 1));
+		r->n += dn;
+		r->t += dt;
+		r->per = dt / dn;
+	}
+	r->left -= 1;
+	*n = r->n;
+	*t = r->t;
+	return 1;
+}
+
+void trc_seek(TRC_ReaderTypeDef *r, uint64_t n) {
+	TRC_ReaderTypeDef s;
+	uint64_t lo = 0, hi = r->blocks, mid, a, t;
+
+	//last block starting at or before n
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (get64(r->map + TRC_HDR + mid * TRC_BLOCK) <= n) lo = mid;
+		else hi = mid;
+	}
+	load(r, lo);
+	for (;;) {
+		s = *r;
+		if (!trc_next(r, &a, &t)) return;
+		if (a >= n) {*r = s; return;}
+	}
+}
+
+void trc_done(TRC_ReaderTypeDef *r) {
+	if (r->map) munmap((void *) r->map, r->size);
+	r->map = NULL;
+}
@@ -0,0 +1,61 @@
+#ifndef _TRACE_H
+#define _TRACE_H
+//header file for the binary edge trace
+//a long edge log as text is ~30 bytes an edge; this is ~3 for a pps. the file is a header and fixed size blocks:
+//	header	TRC_HDR bytes: magic, version, block size, tick rate, edges, blocks, first and last edge number
+//	block	TRC_BLOCK bytes: its first edge (number, tick) and the interval before it in full, then every further edge
+//			as two varints - the edge number step less 1, and the zigzag difference of the tick step from the one
+//			before it (delta of delta: a steady pps costs a byte or two). unused bytes at the end are zero
+//every block decodes on its own and starts at a known offset, so the block headers are the index: the reader maps
+//the file and binary searches them for an edge number, touching O(log blocks) pages
+//numbers are little endian whatever the host
+
+#include <stdio.h>
+#include <stdint.h>
+
+//configuration
+#define TRC_BLOCK			4096			//block size, bytes
+#define TRC_TICK			1e12			//default tick rate, Hz: picoseconds, 213 days in 64 bits
+//end configuration
+
+#define TRC_HDR				64				//header size, bytes
+#define TRC_BHDR			32				//block header size, bytes
+
+//writer: appends into a block in memory, written out when full
+typedef struct {
+	FILE *fp;
+	uint64_t hz;							//ticks per second
+	uint64_t edges, blocks, n_first, n_last;
+	uint64_t t_last, per;					//last tick, and the step before it, per edge number
+	uint8_t blk[TRC_BLOCK];
+	uint32_t used, count;					//bytes and edges in blk
+} TRC_WriterTypeDef;
+
+//reader: the file mapped, and a cursor
+typedef struct {
+	const uint8_t *map;
+	uint64_t size;
+	uint64_t hz, edges, blocks, n_first, n_last;
+	uint64_t b;								//cursor: block, byte in it, bytes used, edges left
+	uint32_t pos, end, left;
+	uint64_t n, t, per;						//last edge decoded, and the step before it
+} TRC_ReaderTypeDef;
+
+//create path, ticks at hz (0: TRC_TICK). returns 0 on success
+int trc_create(TRC_WriterTypeDef *w, const char *path, uint64_t hz);
+//append edge n at tick t: n must grow, t must not fall. returns 0 on success
+int trc_add(TRC_WriterTypeDef *w, uint64_t n, uint64_t t);
+//write out the last block and the header. returns 0 on success
+int trc_close(TRC_WriterTypeDef *w);
+
+//nonzero when path is a trace
+int trc_is(const char *path);
+//map path, cursor on the first edge. returns 0 on success
+int trc_open(TRC_ReaderTypeDef *r, const char *path);
+//cursor on the first edge numbered n or later
+void trc_seek(TRC_ReaderTypeDef *r, uint64_t n);
+//next edge: its number and tick. returns 0 at the end
+int trc_next(TRC_ReaderTypeDef *r, uint64_t *n, uint64_t *t);
+void trc_done(TRC_ReaderTypeDef *r);
+
+#endif
@@ -0,0 +1,101 @@
+#include <string.h>
+#include "vcd.h"							//we write waveforms
+
+static void flush(VCD_TypeDef *v) {
+	if (v->len && (fwrite(v->buf, 1, v->len, v->fp) != v->len)) v->err = 1;
+	v->len = 0;
+}
+
+//room for n more bytes
+static char *room(VCD_TypeDef *v, uint32_t n) {
+	if (v->len + n > VCD_BUF) flush(v);
+	return v->buf + v->len;
+}
+
+static void put(VCD_TypeDef *v, const char *s) {
+	uint32_t n = strlen(s);
+
+	memcpy(room(v, n), s, n);
+	v->len += n;
+}
+
+//identifier code of variable i: printable characters '!'..'~', base 94
+static uint32_t id(char *p, uint8_t i) {
+	uint32_t n = 0;
+
+	do {
+		p[n++] = '!' + i % 94;
+		i /= 94;
+	} while (i);
+	return n;
+}
+
+int vcd_open(VCD_TypeDef *v, const char *path, const char *timescale, const char *scope) {
+	memset(v, 0, sizeof(*v));
+	if (!(v->fp = fopen(path, "w"))) return 1;
+	put(v, "$version avrrun $end\n$timescale ");
+	put(v, timescale);
+	put(v, " $end\n$scope module ");
+	put(v, scope);
+	put(v, " $end\n");
+	return 0;
+}
+
+int vcd_var(VCD_TypeDef *v, const char *name, uint8_t width) {
+	char b[96];
+	uint32_t n;
+
+	if (v->defs || (v->nvar == VCD_VARS) || !width || (width > 32)) return -1;
+	n = snprintf(b, sizeof(b) - 8, "$var wire %u ", width);
+	n += id(b + n, v->nvar);
+	snprintf(b + n, sizeof(b) - n, " %s $end\n", name);
+	put(v, b);
+	v->width[v->nvar] = width;
+	return v->nvar++;
+}
+
+void vcd_time(VCD_TypeDef *v, uint64_t t) {
+	if (!v->defs) {
+		put(v, "$upscope $end\n$enddefinitions $end\n");
+		v->defs = 1;
+	}
+	v->t = t;
+}
+
+void vcd_set(VCD_TypeDef *v, int i, uint32_t val) {
+	char *p;
+	uint32_t n = 0;
+	int8_t b;
+
+	if ((i < 0) || (i >= v->nvar) || (v->known[i] && (v->val[i] == val))) return;
+	v->known[i] = 1;
+	v->val[i] = val;
+	p = room(v, 64);
+	if (!v->stamped || (v->t != v->t_out)) {	//#time ahead of the first change at it
+		n = snprintf(p, 24, "#%llu\n", (unsigned long long) v->t);
+		v->t_out = v->t;
+		v->stamped = 1;
+	}
+	if (v->width[i] == 1) p[n++] = '0' + (val & 1);
+	else {
+		p[n++] = 'b';
+		for (b = v->width[i] - 1; b >= 0; b--) p[n++] = '0' + ((val >> b) & 1);
+		p[n++] = ' ';
+	}
+	n += id(p + n, i);
+	p[n++] = '\n';
+	v->len += n;
+}
+
+int vcd_close(VCD_TypeDef *v) {
+	if (!v->fp) return 1;
+	if (!v->defs) vcd_time(v, 0);
+	if (!v->stamped || (v->t > v->t_out)) {		//end of the dump: a last time stamp
+		snprintf(room(v, 24), 24, "#%llu\n", (unsigned long long) v->t);
+		v->len += strlen(v->buf + v->len);
+	}
+	flush(v);
+	v->err |= (fclose(v->fp) != 0);
+	v->fp = NULL;
+	return v->err;
+}
@@ -0,0 +1,39 @@
+#ifndef _VCD_H
+#define _VCD_H
+//header file for the vcd (value change dump, IEEE 1364) writer: waveforms for gtkwave and the like
+//variables are declared first, then values are set at non-decreasing times: only changes are written, and a
+//time stamp only ahead of the first change at that time. output goes through a buffer of VCD_BUF bytes
+
+#include <stdio.h>
+#include <stdint.h>
+
+//configuration
+#define VCD_VARS			48				//most variables
+#define VCD_BUF				65536			//output buffer, bytes
+//end configuration
+
+typedef struct {
+	FILE *fp;
+	char buf[VCD_BUF];
+	uint32_t len;
+	uint8_t nvar, defs;						//variables, and 1 once the definitions are closed
+	uint8_t width[VCD_VARS];
+	uint32_t val[VCD_VARS];
+	uint8_t known[VCD_VARS];				//val written at least once
+	uint64_t t, t_out;						//time of the next changes, and the last one stamped
+	uint8_t stamped;
+	uint8_t err;
+} VCD_TypeDef;
+
+//create path: timescale such as "1ps", scope the module name. returns 0 on success
+int vcd_open(VCD_TypeDef *v, const char *path, const char *timescale, const char *scope);
+//declare a variable of width bits (1..32), before the first vcd_time(). returns its index, or -1
+int vcd_var(VCD_TypeDef *v, const char *name, uint8_t width);
+//time of the changes that follow, in timescale units
+void vcd_time(VCD_TypeDef *v, uint64_t t);
+//variable i is val from now on
+void vcd_set(VCD_TypeDef *v, int i, uint32_t val);
+//flush and close, stamping the last vcd_time() as the end. returns 0 when everything was written
+int vcd_close(VCD_TypeDef *v);
+
+#endif
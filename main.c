@@ -31,14 +31,25 @@
 //
 //FOUR parameters to pick:
 //1. PS_FUSE: 	fuse setting for divide-by-8 (CKDIV8 bit). 1 (not programmed) or 8 (programmed). ****This setting will impact fuse programming****
-//2. PS_TMR: 	TMR0 clock divider setting. 1/8/64/256/1024.
-//3. TMR_TOP:	timer ticks between each ISR invocation
+//2. PS_TMR: 	TMR0 (or TMR1) clock divider setting. 1/8/64/256/1024.
+//3. TMR_TOP:	timer ticks between each ISR invocation. 1..255 on timer0, 1..65535 on a 16-bit timer1
 //4. ISR_CNT:	the number of ISR invocations needed for each 1PPS pulse
 //
 //other parameters the user must specify:
 //5. F_OSC:		frequency of external oscillator
-//6. PPS_DC:	controls the on duration of the 1PPS signal
+//6. PPS_DC:	controls the on duration of the 1PPS signal: ISR invocations (timer0), timer ticks after the edge (timer1)
 //7. PPS_PIN:	1pps output pin/pins. Signal on the rising edge. Falling edge may have jitter when other programs are running.
+//8. PPS_STATE:	where the isr counter lives. PPS_SRAM (default), PPS_GPIOR (GPIOR0/1) or PPS_REG (r2/r3).
+//				PPS_REG requires -ffixed-r2 -ffixed-r3 on ***EVERY*** file, and no library routine that uses r2/r3 in main()
+//9. PPS_TIMER:	0 = 8-bit timer0 (any part). 1 = 16-bit timer1 in ctc mode (atmega328p, attiny24/44/84):
+//				one isr per period with no reload, and the pulse is ended by compare b - as few as 2 isrs per second
+//10. REF_SRC:	(refin.h) optional reference pps to discipline the output to: none, pin change, ICP1 input capture,
+//				or the analog comparator (attiny85: no input capture, lower and steadier latency than pin change)
+//11. MCU_MINI:	(gpio.h) minimal footprint build for the attiny25: set -DMCU_MINI=1 on every file, link with lto + section gc
+//12. PPS_MODE:	what raises the edge (timer0). PPS_ISR (default): the compare isr, so its latency - and any isr or
+//				cli section that delays it - is the edge's jitter. PPS_HWOC: compare output b (OC0B, PB1 on attiny25/45/85,
+//				set PPS_PIN to (1<<1)), armed a period ahead: the pin changes on the timer tick itself. PPS_POLL: no
+//				compare isr, the main loop polls the match flag - for parts whose interrupts are taken by other work
 //
 //the following conditions ***MUST*** be true:
 //
@@ -80,35 +91,122 @@
 //   8,00Mhz = 8 * 8 * 250 *  500
 //	...
 //
+//examples with a 16-bit timer1 (PPS_TIMER 1)
+//  24,00Mhz = 8 *64 * 46875 *    1
+//  20,00Mhz = 8 * 8 * 62500 *    5
+//  19,44Mhz = 8 * 8 * 60750 *    5
+//  19,20Mhz = 8 *64 * 37500 *    1
+//  16,384Mhz= 8 *64 * 32000 *    1
+//  16,00Mhz = 8 *64 * 31250 *    1
+//  12,80Mhz = 8 *64 * 25000 *    1
+//  10,00Mhz = 8 * 8 * 31250 *    5
+//	...
+//
 
 #include "gpio.h"
 #include "delay.h"							//we use software delays
-#include "tmr0oc.h"							//we use timer0
-//#include "tmr1oc.h"						//we use timer1
+#include "telem.h"							//we report cpu budget
+#include "refin.h"							//we timestamp the reference pps
+#include "disc.h"							//we discipline to the reference
+#include "rdiv.h"							//we use reciprocal division
 
 
 //hardware configuration
+//each setting can also be given on the command line (-DTMR_TOP=250 ...), as host/isrbench.sh does
+#ifndef F_OSC
 #define F_OSC		19440000ul				//external oscillator speed
+#endif
+#ifndef PS_FUSE
 #define PS_FUSE		8						//8 (default) or 1: fuse setting for 8x divider.
-#define PS_TMR		8						//1/8/64/256/1024: clock divider setting for TMR0
+#endif
+//PS_TMR: default in gpio.h - every file needs it
+#ifndef TMR_TOP
 #define TMR_TOP		243						//steps in which TMR0 output compare advances
+#endif
+#ifndef ISR_CNT
 #define ISR_CNT		1250					//number of ISR invocation for each 1PPS pulse
+#endif
+#ifndef PPS_DC
 #define PPS_DC		10						//1PPS on / high duration - between 1 and ISR_CNT
+#endif
 
 #define PPS_PORT	PORTB
 #define PPS_DDR		DDRB
+#define PPS_PINR	PINB					//writing 1s to it flips PPS_PORT bits
+#ifndef PPS_PIN
 #define PPS_PIN		(1<<2)					//1PPS output on PB2. Multiple pins are allowed
+#endif
+#ifndef PPS_STATE
+#define PPS_STATE	PPS_SRAM				//PPS_SRAM, PPS_GPIOR or PPS_REG: placement of the isr counter
+#endif
+//PPS_TIMER: default in gpio.h - every file needs it
+#ifndef PPS_MODE
+#define PPS_MODE	PPS_ISR					//PPS_ISR, PPS_HWOC or PPS_POLL: what raises the 1pps edge
+#endif
 //end hardware configuration
 
+#if PPS_TIMER == 1
+#include "tmr1oc.h"							//we use timer1
+#else
+#include "tmr0oc.h"							//we use timer0
+#endif
+
 //global defines
+//isr counter placement: what the decrement + zero test in pps_out() costs per isr invocation
+//isrbench.sh measures the TIM0_COMPA worst / average cycles of each (feature sets PPS_SRAM / PPS_GPIOR / PPS_REG)
+#define PPS_SRAM	0						//a volatile uint16_t in sram: lds / sts of both bytes
+#define PPS_GPIOR	1						//GPIOR0 / GPIOR1: in / out, no sram traffic
+#define PPS_REG		2						//r2 / r3, reserved with -ffixed-r2 -ffixed-r3: no loads or stores, and main() reads the counter with one movw
+
+//edge engine
+#define PPS_ISR		0						//compare isr raises the pin: edge = match + isr latency
+#define PPS_HWOC	1						//compare output b raises the pin on the match: no latency, one pin
+#define PPS_POLL	2						//main loop polls the match: edge = match + loop latency
+
 //set fuse clock divider
 #if PS_FUSE == 8
 #define F_CLK		(F_OSC/8)				//oscillator timer clock, in HZ
 #else
 #define F_CLK		(F_OSC/1)
 #endif
+#define PPS_TPS		(F_CLK / PS_TMR)		//timer ticks per second
+
+//limits of a one-period timing adjustment, in ticks. kept within int16_t
+//the match is moved from pps_out, after isr entry, cnt_dec and telem_sec - and maybe behind a reference isr. a match
+//moved behind the counter is missed: a 65536 (timer1) / 256 (timer0) tick glitch. so the shortest period keeps
+//PPS_ADJLAT cpu cycles, in ticks and rounded up, plus a tick of margin ahead of the match that started it
+#ifndef PPS_ADJLAT
+#define PPS_ADJLAT	384						//worst-case cycles from the match to the OCR write in pps_out
+#endif
+#define PPS_ADJGAP	((PPS_ADJLAT + PS_TMR - 1) / PS_TMR + 1)	//shortest period, in ticks
+#if PPS_TIMER == 1
+#define PPS_ADJMAX	((65535 - TMR_TOP > 32767) ? 32767 : (65535 - TMR_TOP))	//ctc period can grow up to 16 bits
+#define PPS_ADJMIN	((TMR_TOP - PPS_ADJGAP > 32767) ? -32767 : (PPS_ADJGAP - TMR_TOP))	//next match must stay ahead of the counter
+#else
+#define PPS_ADJMAX	(255 - TMR_TOP)			//next match must stay within 8 bits
+#define PPS_ADJMIN	(PPS_ADJGAP - TMR_TOP)	//next match must stay ahead of the counter
+#endif
 
 //checking for error conditions
+#if PPS_TIMER == 1
+//set TMR1 to valid prescalers
+#if !TMR1_16BIT
+#error "PPS_TIMER 1 needs a 16-bit timer1 (atmega328p, attiny24/44/84)"
+#endif
+#if PS_TMR == 1
+#define PPS_PS		TMR1_PS1x
+#elif PS_TMR == 8
+#define PPS_PS		TMR1_PS8x
+#elif PS_TMR == 64
+#define PPS_PS		TMR1_PS64x
+#elif PS_TMR == 256
+#define PPS_PS		TMR1_PS256x
+#elif PS_TMR == 1024
+#define PPS_PS		TMR1_PS1024x
+#else
+#error "Invalid PS_TMR settings!"
+#endif
+#elif PPS_TIMER == 0
 //set TMR0 to valid prescalers
 #if PS_TMR == 1
 #define PPS_PS		TMR0_PS1x				//8x is also a good choice
@@ -118,11 +216,14 @@
 #define PPS_PS		TMR0_PS64x				//8x is also a good choice
 #elif PS_TMR == 256
 #define PPS_PS		TMR0_PS256x				//8x is also a good choice
-#elif
+#elif PS_TMR == 1024
 #define PPS_PS		TMR0_PS1024x			//8x is also a good choice
 #else
 #error "Invalid PS_TMR settings!"
 #endif
+#else
+#error "Invalid PPS_TIMER settings!"
+#endif
 
 //check to see if F_OSC = PS_FUSE * PS_TMR * TMR*TOP * ISR_CNT
 //report error if not equal
@@ -130,8 +231,12 @@
 #error "F_OSC not divisable by PS_FUSE, PS_TMR, TMR_TOP, and ISR_CNT"
 #endif
 
-//check if TMR_TOP is more than 8bit
-#if TMR_TOP > 255
+//check if TMR_TOP fits the timer
+#if PPS_TIMER == 1
+#if TMR_TOP > 65535
+#error "TMR_TOP is too large: it must be between 32 - 65535"
+#endif
+#elif TMR_TOP > 255
 #error "TMR_TOP is too large: it must be between 32 - 255"
 #endif
 
@@ -140,35 +245,272 @@
 #error "ISR_CNT is too large: it must be between 1 - 65536"
 #endif
 
+#if PPS_TIMER == 1
+//make sure the pulse ends within the first timer period
+#if PPS_DC >= TMR_TOP
+#error "PPS_DC is too big: it must be less than TMR_TOP"
+#endif
+#else
 //make sure PPS_DC is less than ISR_CNT
-#if PPS_CN > ISR_CNT
+#if PPS_DC >= ISR_CNT
 #error "PPS_DC is too big: it must be less than ISR_CNT"
 #endif
+#endif
+
+//a correction needs room to shorten a period
+#if (REF_SRC != REF_NONE) && (PPS_ADJGAP >= TMR_TOP)
+#error "TMR_TOP is too short for a correction: a period must be more than PPS_ADJLAT cycles long"
+#endif
+
+//input capture stamps TCNT1 - only meaningful when timer1 runs the engine
+#if (REF_SRC == REF_ICP) && (PPS_TIMER != 1)
+#error "REF_ICP needs PPS_TIMER 1"
+#endif
+
+//the minimal footprint build binds its handlers through tmr0oc.h / refin.h
+#if MCU_MINI && (PPS_TIMER != 0)
+#error "MCU_MINI needs PPS_TIMER 0"
+#endif
+
+//the other edge engines run on timer0's compare a
+#if (PPS_MODE != PPS_ISR) && (PPS_TIMER != 0)
+#error "PPS_HWOC / PPS_POLL need PPS_TIMER 0"
+#endif
+#if (PPS_MODE == PPS_HWOC) && (PPS_PIN != (1<<1))
+#error "PPS_HWOC drives OC0B: PPS_PIN must be (1<<1), PB1"
+#endif
+#if (PPS_MODE == PPS_HWOC) && (REF_SRC == REF_ACOMP)
+#error "PPS_HWOC drives PB1, which REF_ACOMP takes as AIN1"
+#endif
 //end error checking
 
+//1pps output strobes - atomic, so the main loop cannot tear the isr's edge
+#if IO_MULTI(PPS_PIN)
+//pin group: pins are always low when the edge is due (cleared PPS_DC isr invocations / ticks after the previous edge)
+//so a single flip via PINx raises them all in one out
+#define PPS_HI()	PIN_FLP(PPS_PINR, PPS_PIN)
+#define PPS_LO()	do {if (IO_GET(PPS_PORT, PPS_PIN)) PIN_FLP(PPS_PINR, PPS_PIN);} while (0)
+#else
+//single pin: sbi / cbi
+#define PPS_HI()	PIN_SET(PPS_PORT, IO_BIT(PPS_PIN))
+#define PPS_LO()	PIN_CLR(PPS_PORT, IO_BIT(PPS_PIN))
+#endif
+
 //global variables
+#if PPS_STATE == PPS_REG
+register uint8_t cnt_lo asm("r2");			//isr counter, lsb - r2/r3 reserved via -ffixed-r2 -ffixed-r3
+register uint8_t cnt_hi asm("r3");			//isr counter, msb
+#elif PPS_STATE == PPS_GPIOR
+#define cnt_lo		GPIOR0					//isr counter, lsb
+#define cnt_hi		GPIOR1					//isr counter, msb
+#elif PPS_STATE == PPS_SRAM
 volatile uint16_t cnt=ISR_CNT;
+#else
+#error "Invalid PPS_STATE settings!"
+#endif
+
+//load the isr counter
+static inline void cnt_set(uint16_t val) {
+#if PPS_STATE == PPS_SRAM
+	cnt = val;
+#else
+	cnt_hi = val >> 8;
+	cnt_lo = val;
+#endif
+}
+
+//decrement the isr counter - downcounter
+//returns 1 when it reaches 0
+static inline uint8_t cnt_dec(void) {
+#if PPS_STATE == PPS_SRAM
+	cnt-=1;
+	return cnt == 0;
+#else
+	if (cnt_lo == 0) cnt_hi -= 1;			//borrow from the msb
+	cnt_lo -= 1;
+	return (cnt_lo | cnt_hi) == 0;
+#endif
+}
+
+//read the isr counter from the main loop
+static inline uint16_t cnt_get(void) {
+#if PPS_STATE == PPS_REG
+	uint16_t val;
+	asm volatile ("movw %A0, r2" : "=r" (val));	//atomic, and never hoisted out of the main loop
+	return val;
+#elif PPS_STATE == PPS_GPIOR
+	uint8_t hi, lo;
+	do {
+		hi = cnt_hi;
+		lo = cnt_lo;
+	} while (hi != cnt_hi);					//msb changed under us - read again
+	return ((uint16_t) hi << 8) | lo;
+#else
+	return cnt;
+#endif
+}
+
+#if REF_SRC != REF_NONE
+//reference stamps: isr -> main loop
+volatile uint8_t ref_rdy;					//1: ref_tick holds a new reference edge
+volatile uint32_t ref_tick;					//reference edge, ticks after the local edge
+//corrections: main loop -> isr
+volatile uint8_t adj_rdy;					//1: a correction waits for the next local edge
+volatile int16_t adj_per;					//periods to add to the next second
+volatile int16_t adj_tck;					//ticks to add to the first period of the next second
+int16_t run_per, run_tck;					//the correction applied to the second under way: pps_ref measures against it
+RDIV_TypeDef rd_top;						//reciprocal of TMR_TOP
+uint16_t pps_end;							//isr count that ends the pulse, in the second under way
+#define PPS_END		pps_end
+#else
+#define PPS_END		(ISR_CNT - PPS_DC)		//every second is ISR_CNT periods long
+#endif
+
+#if MCU_MINI
+#if PPS_STATE == PPS_SRAM
+#define PPS_RAM		(sizeof(cnt))
+#else
+#define PPS_RAM		0
+#endif
+#if REF_SRC != REF_NONE
+RAM_CHK(_pps_ram_chk, PPS_RAM + sizeof(ref_rdy) + sizeof(ref_tick) + sizeof(adj_rdy) + sizeof(adj_per) + sizeof(adj_tck) + sizeof(run_per) + sizeof(run_tck) + sizeof(rd_top) + sizeof(pps_end), MINI_RAM_PPS);
+#else
+RAM_CHK(_pps_ram_chk, PPS_RAM, MINI_RAM_PPS);
+#endif
+#endif
+
+#if REF_SRC != REF_NONE
+
+//user code for the reference isr: turn the raw counter stamp into ticks after the local edge
+//the compare isr for the period the stamp falls in may still be pending - the reference isr can preempt or precede it
+//the second under way is ISR_CNT + run_per periods long, its first one stretched by run_tck ticks
+void pps_ref(uint16_t stamp) {
+	int32_t len = ISR_CNT + run_per;		//periods in the second under way
+	int32_t per = len - cnt_get();			//periods since the local edge
+	int32_t el;								//ticks since the local edge, less per whole periods
+#if PPS_TIMER == 1
+	el = stamp;								//ctc: counter restarted at the last match
+	if ((TMR1_TIFR & (1<<OCF1A)) && (el < TMR_TOP / 2)) per += 1;	//stamp is past a match whose isr is pending
+	if (per >= len) per -= len;				//the pending match was the local edge
+	else if (per > 0) el += run_tck;		//past the stretched first period
+#else
+	uint8_t nxt = OCR0A;					//next match point
+	if ((TMR0_TIFR & (1<<OCF0A)) && ((uint8_t) (stamp - nxt) < TMR_TOP / 2)) {
+		el = (uint8_t) (stamp - nxt);		//stamp is past a match whose isr is pending
+		per += 1;
+	} else el = TMR_TOP - (uint8_t) (nxt - stamp);	//the first period's match is moved by run_tck: el may be < 0
+	if (per >= len) per -= len;				//the pending match was the local edge
+	else el += run_tck;						//the first period ran run_tck ticks long, this one is in or past it
+#endif
+	if (per < 0) per += len;
+	if (ref_rdy) return;					//main loop has not taken the last one
+	ref_tick = XMUL((uint32_t) per, TMR_TOP) + el;
+	ref_rdy = 1;
+}
+
+//discipline - main loop task
+//split the loop's correction into whole periods (via the isr counter) and a one-period timer adjustment
+void pps_disc(void) {
+	int32_t c;
+	uint32_t mag;
+	int16_t per;
+	int32_t tck;							//up to +/-TMR_TOP before it is clamped
+
+	if (!ref_rdy) return;					//no new reference edge
+	c = disc_ref(ref_tick);
+	ref_rdy = 0;
+	if (adj_rdy) return;					//last correction not applied yet
+	mag = (c < 0) ? -c : c;
+	per = rdiv(&rd_top, mag);				//mag / TMR_TOP
+	tck = mag - XMUL((uint32_t) per, TMR_TOP);
+	if (c < 0) {per = -per; tck = -tck;}
+	if (tck > PPS_ADJMAX) {per += 1; tck -= TMR_TOP;}	//too long for one period: one more, then shrink
+	if (tck < PPS_ADJMIN) tck = PPS_ADJMIN;	//residual is left to the loop
+	if (tck > PPS_ADJMAX) tck = PPS_ADJMAX;
+	adj_per = per;
+	adj_tck = tck;
+	adj_rdy = 1;
+}
+#endif
 
 //user code for timer1 isr
 void pps_out(void) {
+#if (REF_SRC != REF_NONE) && (PPS_TIMER == 1)
+	int16_t tck = 0;							//ctc period stretch for the period under way
+#endif
 
-	cnt-=1;										//decrement cnt - downcounter
-	if (cnt == 0) {								//if enough isr invocations have passed
-		cnt = ISR_CNT;							//reset cnt
+	if (cnt_dec()) {							//if enough isr invocations have passed
+		cnt_set(ISR_CNT);						//reset cnt
+#if PPS_MODE != PPS_HWOC
 		//strobe the output pin
-		IO_SET(PPS_PORT, PPS_PIN);
+		PPS_HI();
+#endif
+		telem_sec();							//close the accounting second, after the edge
+#if REF_SRC != REF_NONE
+		run_per = run_tck = 0;
+		if (adj_rdy) {							//apply the discipline's correction, after the edge
+			cnt_set(ISR_CNT + adj_per);
+			run_per = adj_per;
+			run_tck = adj_tck;
+#if PPS_TIMER == 1
+			tck = adj_tck;
+#else
+			tmr0a_adj(adj_tck);
+#endif
+			adj_rdy = 0;
+		}
+		//the pulse ends PPS_DC periods into the second actually loaded - or a period before the next edge, if that is shorter
+		pps_end = ((int32_t) ISR_CNT + run_per > PPS_DC) ? ISR_CNT + run_per - PPS_DC : 1;
+#endif
 	}
+#if (PPS_TIMER == 0) && (PPS_MODE != PPS_HWOC)
+	//turn off 1pps output. here rather than in the main loop: every count passes through this isr
+	else if (cnt_get() == PPS_END) PPS_LO();
+#endif
+#if (REF_SRC != REF_NONE) && (PPS_TIMER == 1)
+	tmr1a_adj(tck);								//stretch this period, or restore the last one
+#endif
+#if PPS_MODE == PPS_HWOC
+	//arm compare output b a period ahead: up at the edge's match, down at the match that brings the count to PPS_END
+	if (cnt_get() == 1) tmr0b_ocfollow(TMR0_OCSET);
+	else if (cnt_get() == PPS_END + 1) tmr0b_ocfollow(TMR0_OCCLR);
+#endif
 }
 
+#if PPS_TIMER == 1
+//user code for timer1 compare b isr: end the pulse
+//fires PPS_DC ticks into every period - harmless when the output is already low
+void pps_off(void) {
+	PPS_LO();
+}
+#endif
+
 //initialize the pps calibrator
 void pps_init(uint32_t ps) {
 	//initialize isr counter
-	cnt = ISR_CNT;
+	cnt_set(ISR_CNT);
+	telem_init();							//reset cpu budget accounting
+#if REF_SRC != REF_NONE
+	ref_rdy = adj_rdy = 0;
+	run_per = run_tck = 0;
+	pps_end = ISR_CNT - PPS_DC;
+	rdiv_init(&rd_top, TMR_TOP);
+	disc_init(PPS_TPS, (REF_LAT + PS_TMR / 2) / PS_TMR);	//latency in ticks, rounded
+#endif
 
 	//initialize pps low, as output
 	IO_CLR(PPS_PORT, PPS_PIN);
 	IO_OUT(PPS_DDR, PPS_PIN);
 
+#if PPS_TIMER == 1
+	//initialize TIMER1: ctc, one isr per TMR_TOP ticks, compare b ends the pulse
+	ps = ps & TMR1_PSMASK;
+	tmr1_init(ps);							//initialize TMR1
+	tmr1a_setpr(TMR_TOP);					//period
+	tmr1b_setpr(PPS_DC);					//pulse width
+	tmr1b_act(pps_off);						//install pulse end handler
+	tmr1a_act(pps_out);						//install user handler
+#else
 	//initialize TIMER1
 	ps = ps & TMR0_PSMASK;
 	tmr0_init(ps);							//initialize TMR0
@@ -180,8 +522,21 @@ void pps_init(uint32_t ps) {
 	//	case TMR0_PS256x: 	tmr0a_setpr(F_CLK /   256 / ISR_CNT); break;
 	//	case TMR0_PS1024x: 	tmr0a_setpr(F_CLK /  1024 / ISR_CNT); break;
 	//}
+	//or, at run time, with a shift for the prescaler and a reciprocal (rdiv.h) for ISR_CNT:
+	//	rdiv_init(&rd, ISR_CNT); tmr0a_setpr(rdiv(&rd, RDIV_SH(F_CLK, TMR0_PSSH(ps))));
 	tmr0a_setpr(TMR_TOP);					//alternatively
+#if PPS_MODE == PPS_HWOC
+	tmr0b_ocfollow(TMR0_OCCLR);				//OC0B takes the pin, low
+#endif
+#if PPS_MODE == PPS_POLL
+	tmr0a_poll_act(pps_out);				//install user handler, run from the main loop
+#else
 	tmr0a_act(pps_out);						//install user handler
+#endif
+#endif
+#if REF_SRC != REF_NONE
+	ref_init(pps_ref);						//start timestamping the reference
+#endif
 	//1PPS generator now running
 	//needs to enable global interrupt in main()
 }
@@ -192,8 +547,19 @@ int main(void) {
 	pps_init(PPS_PS);						//reset the pss
 	ei();									//enable global interrupts
 	while(1) {
-		//turn off 1pps output
-		if (cnt == ISR_CNT - PPS_DC) IO_CLR(PPS_PORT, PPS_PIN);
+#if PPS_MODE == PPS_POLL
+		TELEM_ENTER(TELEM_TASK);			//start accounting
+		tmr0a_poll();						//the 1pps engine, if its match has come
+		TELEM_EXIT(TELEM_TASK);				//end accounting
+#endif
+		TELEM_ENTER(TELEM_TLM);
+		telem_poll();						//latch last second's cpu budget
+		TELEM_EXIT(TELEM_TLM);
+#if REF_SRC != REF_NONE
+		TELEM_ENTER(TELEM_DSC);
+		pps_disc();							//steer onto the reference
+		TELEM_EXIT(TELEM_DSC);
+#endif
 	}
 
 	return 0;
@@ -0,0 +1,52 @@
+#include "rdiv.h"						//we use reciprocal division
+
+//(a * b) >> 32, shift-add over the set bits of b
+//lsb first: the running sum is shifted right one bit per bit of b, so only its high word is kept
+uint32_t rdiv_mulhi(uint32_t a, uint32_t b) {
+	uint32_t hi = 0;						//high word of the running sum
+	uint8_t sh = 32;						//shifts left to do
+	uint8_t c;								//carry out of the high word
+
+	while (b) {								//stop as soon as b runs out of set bits
+		c = 0;
+		if (b & 1) {
+			hi += a;
+			c = hi < a;						//carry into bit 32
+		}
+		hi = (hi >> 1) | ((uint32_t) c << 31);
+		b >>= 1;
+		sh -= 1;
+	}
+	return (sh < 32) ? (hi >> sh) : 0;		//remaining shifts in one go
+}
+
+//compute the reciprocal of d
+void rdiv_init(RDIV_TypeDef *rd, uint32_t d) {
+	uint8_t l, i, c;
+	uint32_t r, q;
+
+	//l = ceil(log2(d))
+	for (l = 0; (l < 32) && (((uint32_t) 1 << l) < d); l++) continue;
+	//q = floor(2^32 * (2^l - d) / d). the high word (2^l - d) is less than d, so q fits 32 bits
+	r = ((l < 32) ? ((uint32_t) 1 << l) : 0) - d;	//2^l - d, 2^32 wraps to 0
+	q = 0;
+	for (i = 0; i < 32; i++) {
+		c = r >> 31;						//bit 32 of the shifted remainder
+		r <<= 1;
+		q <<= 1;
+		if (c || (r >= d)) {
+			r -= d;
+			q |= 1;
+		}
+	}
+	rd->mul = q + 1;
+	rd->sh1 = (l < 1) ? l : 1;
+	rd->sh2 = (l > 1) ? l - 1 : 0;
+}
+
+//n / d
+uint32_t rdiv(const RDIV_TypeDef *rd, uint32_t n) {
+	uint32_t t = rdiv_mulhi(rd->mul, n);
+
+	return (t + ((n - t) >> rd->sh1)) >> rd->sh2;
+}
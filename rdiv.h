@@ -0,0 +1,38 @@
+#ifndef _RDIV_H
+#define _RDIV_H
+//header file for division by run-time invariant divisors
+//the core has neither a divide nor a multiply instruction: a 32-bit division through __udivmodsi4 costs ~600 cycles
+//
+//power-of-two divisors (timer prescalers) need only a shift: see TMR0_PSSH() / TMR1_PSSH()
+//other divisors are turned into a reciprocal once, by rdiv_init(), and every later division is a multiply-high and two shifts
+//the multiply-high is shift-add over the bits of the dividend and stops early, so small dividends (phase errors in ticks,
+//ppb conversions) take a handful of iterations. a full 32-bit dividend takes about as long as a plain division
+//
+//method: T. Granlund, P. Montgomery, "Division by Invariant Integers using Multiplication", fig 4.1
+
+#include "gpio.h"
+
+//hardware configuration
+//end hardware configuration
+
+//reciprocal of a divisor
+typedef struct {
+	uint32_t mul;							//m' = floor(2^32 * (2^l - d) / d) + 1, l = ceil(log2(d))
+	uint8_t sh1;							//min(l, 1)
+	uint8_t sh2;							//max(l - 1, 0)
+} RDIV_TypeDef;
+
+//divide by a power of two
+#define RDIV_SH(n, sh)		((n) >> (sh))
+
+//compute the reciprocal of d. d must not be 0
+//uses a single 64/32 restoring division - call it when the divisor changes, not per use
+void rdiv_init(RDIV_TypeDef *rd, uint32_t d);
+
+//n / d, for the d given to rdiv_init()
+uint32_t rdiv(const RDIV_TypeDef *rd, uint32_t n);
+
+//(a * b) >> 32, shift-add over the set bits of b
+uint32_t rdiv_mulhi(uint32_t a, uint32_t b);
+
+#endif
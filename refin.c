@@ -0,0 +1,91 @@
+#include "refin.h"						//we use the reference input
+#include "telem.h"						//we account isr cycles
+#if REF_SRC == REF_ICP
+#include "tmr1oc.h"						//we use timer1 input capture
+#endif
+
+#if MCU_MINI
+#define REF_CALL(stamp)		REF_HOOK(stamp)	//handler named at build time
+#else
+//empty handler
+static void empty_handler(uint16_t stamp) {
+	//default reference handler
+}
+
+static void (* _isrptr_ref)(uint16_t stamp)=empty_handler;	//ref_ptr pointing to empty_handler by default
+#define REF_CALL(stamp)		_isrptr_ref(stamp)
+#endif
+
+#if REF_SRC == REF_PCINT
+//pin change registers differ across parts
+#if defined(PCICR)
+#define REF_PCIE()			do {PCIFR |= (1<<PCIF0); PCMSK0 |= REF_PIN; PCICR |= (1<<PCIE0);} while (0)	//atmega328p
+#else
+#define REF_PCIE()			do {GIFR |= (1<<PCIF); PCMSK |= REF_PIN; GIMSK |= (1<<PCIE);} while (0)		//attiny25/45/85
+#endif
+
+//pin change isr
+ISR(PCINT0_vect) {
+	uint16_t stamp = REF_TCNT;				//stamp first - everything before it is latency
+	TELEM_ENTER(TELEM_REF);					//start accounting
+	if (IO_GET(REF_PINR, REF_PIN)) REF_CALL(stamp);	//rising edges only
+	TELEM_EXIT(TELEM_REF);					//end accounting
+}
+#endif
+
+#if REF_SRC == REF_ACOMP
+//comparator registers differ across parts
+#if defined(ANALOG_COMP_vect)
+#define REF_ACVECT			ANALOG_COMP_vect						//atmega328p
+#define REF_DIDR			DIDR1
+#else
+#define REF_ACVECT			ANA_COMP_vect							//attiny25/45/85
+#define REF_DIDR			DIDR0
+#endif
+//the interrupt fires on a comparator output edge. the output is high when the + input is above the - input
+#if REF_ACBG
+#define REF_ACIS			(1<<ACIS1)								//reference on the - input: its rising edge is a falling output
+#define REF_ACIN			(1<<AIN1D)
+#else
+#define REF_ACIS			((1<<ACIS1) | (1<<ACIS0))				//reference on the + input: rising output
+#define REF_ACIN			((1<<AIN1D) | (1<<AIN0D))
+#endif
+
+//analog comparator isr
+//the edge is selected by the hardware: no pin test, so the path to the stamp is fixed
+ISR(REF_ACVECT) {
+	uint16_t stamp = REF_TCNT;				//stamp first - everything before it is latency
+	TELEM_ENTER(TELEM_REF);					//start accounting
+	REF_CALL(stamp);
+	TELEM_EXIT(TELEM_REF);					//end accounting
+}
+#endif
+
+#if REF_SRC == REF_ICP
+#if !TMR1_16BIT
+#error "REF_ICP needs a 16-bit timer1 with input capture (atmega328p, attiny24/44/84)"
+#endif
+//input capture handler: the stamp was taken by the hardware
+static void _ref_icp(void) {
+	REF_CALL(tmr1ic_get());
+}
+#endif
+
+//start timestamping the reference
+void ref_init(void (*isr_ptr)(uint16_t stamp)) {
+#if !MCU_MINI
+	_isrptr_ref = isr_ptr;					//install user handler
+#endif
+#if REF_SRC == REF_PCINT
+	IO_IN(REF_DDR, REF_PIN);				//reference pin as input
+	REF_PCIE();								//pin change interrupt on REF_PIN: enabled
+#elif REF_SRC == REF_ICP
+	tmr1ic_edge(TMR1_ICRISE);				//capture rising edges
+	tmr1ic_act(_ref_icp);					//install capture handler
+#elif REF_SRC == REF_ACOMP
+	REF_DIDR |= REF_ACIN;					//digital input buffers off on the comparator pins
+	ACSR = (REF_ACBG ? (1<<ACBG) : 0) | REF_ACIS;	//comparator on (ACD cleared - mcu_init() turned it off), edge selected, interrupt still off
+	ACSR |= (1<<ACI);						//clear the flag set while the edge was selected
+	ACSR |= (1<<ACIE);						//analog comparator interrupt: enabled
+#endif
+}
@@ -0,0 +1,53 @@
+#ifndef _REFIN_H
+#define _REFIN_H
+//header file for the reference (gps) pps input
+//every rising edge of the reference is timestamped with the 1pps engine's counter
+//and handed to a user handler - the same handler regardless of where the stamp came from
+
+#include "gpio.h"
+
+//reference sources
+#define REF_NONE			0				//no reference input
+#define REF_PCINT			1				//pin change interrupt on REF_PIN, REF_TCNT read by the isr
+#define REF_ICP				2				//ICP1 input capture: TCNT1 latched into ICR1 by the timer hardware (16-bit timer1 parts)
+#define REF_ACOMP			3				//analog comparator isr on AIN0/AIN1, REF_TCNT read by the isr
+
+//hardware configuration
+#ifndef REF_SRC
+#define REF_SRC				REF_NONE		//REF_NONE, REF_PCINT, REF_ICP or REF_ACOMP
+#endif
+#define REF_DDR				DDRB
+#define REF_PINR			PINB			//pin change input register
+#define REF_PIN				(1<<0)			//reference on PB0 (PCINT0). ICP1 is fixed: PB0 on atmega328p, PA7 on attiny84
+#if PPS_TIMER == 1
+#define REF_TCNT			TCNT1			//the 1pps engine's counter: timer0 is not running
+#else
+#define REF_TCNT			TCNT0			//the 1pps engine's counter
+#endif
+#define REF_ACBG			0				//REF_ACOMP: 0 = reference on AIN0 (PB0), threshold on AIN1 (PB1). 1 = reference on AIN1, 1.1v bandgap threshold
+#if MCU_MINI
+#define REF_HOOK			pps_ref			//handler named at build time: ref_init() ignores isr_ptr
+#endif
+//end hardware configuration
+
+//stamp latency, in cpu cycles from the reference edge to the counter sample
+//subtracted by the discipline loop. PCINT / ACOMP: the average measured in the emulator (avrrun -g, isrbench.sh),
+//the isr saving r0, r1, SREG and the 12 call clobbered registers for REF_CALL before REF_TCNT is read.
+//a handler inlined at build time saves fewer - measure and override with -DREF_LAT=n
+#ifndef REF_LAT
+#if REF_SRC == REF_ICP
+#define REF_LAT				2				//input synchronizer only
+#elif REF_SRC == REF_ACOMP
+#define REF_LAT				44				//sync (2) + comparator delay (~4) + isr entry (4) + vector jump (2) + prologue (32), 43..46 measured
+#else
+#define REF_LAT				41				//sync (2) + isr entry (4) + vector jump (2) + prologue (32), 40..48 measured
+#endif
+#endif
+
+//start timestamping the reference. isr_ptr runs in isr context with the stamp
+void ref_init(void (*isr_ptr)(uint16_t stamp));
+#if defined(REF_HOOK)
+void REF_HOOK(uint16_t stamp);
+#endif
+
+#endif
@@ -0,0 +1,88 @@
+#include "telem.h"						//we use telemetry
+
+//global variables
+volatile uint32_t _telem_acc[TELEM_N];		//ticks accumulated in the current second
+volatile uint16_t _telem_run[TELEM_N];		//invocations in the current second
+volatile uint8_t _telem_max[TELEM_N];		//longest single invocation since reset
+volatile uint8_t _telem_sec;				//1: a second has ended, waiting to be latched
+#if TELEM_TQ
+volatile uint16_t _telem_late[TELEM_N];		//late compare isrs since telem_clr()
+volatile uint16_t _telem_ovr[TELEM_N];		//compare points loaded behind the counter since telem_clr()
+volatile uint16_t _telem_pend[TELEM_N];		//isr exits with the flag already set since telem_clr()
+#endif
+static TELEM_TypeDef _telem;				//last latched snapshot
+#if MCU_MINI
+#if TELEM_TQ
+#define TELEM_TQ_RAM		(sizeof(_telem_late) + sizeof(_telem_ovr) + sizeof(_telem_pend))
+#else
+#define TELEM_TQ_RAM		0
+#endif
+RAM_CHK(_telem_ram_chk, sizeof(_telem_acc) + sizeof(_telem_run) + sizeof(_telem_max) + sizeof(_telem_sec) + TELEM_TQ_RAM + sizeof(_telem), MINI_RAM_TELEM);
+#endif
+
+//reset telemetry
+void telem_init(void) {
+	uint8_t i;
+	uint8_t sreg = SREG;					//may be called with interrupts on or off
+
+	di();									//isrs may be running
+	for (i = 0; i < TELEM_N; i++) {
+		_telem_acc[i] = 0;
+		_telem_run[i] = 0;
+		_telem_max[i] = 0;
+		_telem.busy[i] = _telem.peak[i] = 0;
+		_telem.runs[i] = 0;
+		_telem.max[i] = 0;
+	}
+	_telem.secs = 0;
+	_telem_sec = 0;
+	SREG = sreg;							//restore interrupt state
+	telem_clr();							//reset timing quality counters
+}
+
+//latch the last second's totals
+void telem_poll(void) {
+	uint8_t i;
+
+	if (_telem_sec == 0) return;			//second not over yet
+	di();									//isr accumulators are shared
+	for (i = 0; i < TELEM_N; i++) {
+		_telem.busy[i] = _telem_acc[i]; _telem_acc[i] = 0;
+		_telem.runs[i] = _telem_run[i]; _telem_run[i] = 0;
+		_telem.max[i] = _telem_max[i];
+#if TELEM_TQ
+		_telem.late[i] = _telem_late[i];
+		_telem.ovr[i] = _telem_ovr[i];
+		_telem.pend[i] = _telem_pend[i];
+#endif
+	}
+	_telem_sec = 0;
+	ei();
+	//peaks are main loop only - no need to block isrs
+	for (i = 0; i < TELEM_N; i++)
+		if (_telem.busy[i] > _telem.peak[i]) _telem.peak[i] = _telem.busy[i];
+	_telem.secs += 1;
+#if TELEM_DISC
+	disc_read(&_telem.disc);				//main loop only, like disc_ref()
+#endif
+}
+
+//copy the last latched snapshot
+void telem_read(TELEM_TypeDef *dst) {
+	*dst = _telem;							//only written by telem_poll() in the main loop
+}
+
+//clear the timing quality counters
+void telem_clr(void) {
+#if TELEM_TQ
+	uint8_t i;
+	uint8_t sreg = SREG;					//may be called with interrupts on or off
+
+	di();									//counters are written by isrs
+	for (i = 0; i < TELEM_N; i++) {
+		_telem_late[i] = _telem_ovr[i] = _telem_pend[i] = 0;
+		_telem.late[i] = _telem.ovr[i] = _telem.pend[i] = 0;
+	}
+	SREG = sreg;							//restore interrupt state
+#endif
+}
@@ -0,0 +1,170 @@
+#ifndef _TELEM_H
+#define _TELEM_H
+//header file for telemetry
+//per-second cpu budget accounting for isrs and main loop tasks
+
+#include "gpio.h"
+#include "refin.h"						//REF_SRC
+#include "disc.h"						//the discipline loop's state, for the snapshot
+
+//hardware configuration
+#ifndef TELEM_CPU
+#define TELEM_CPU			1				//1: account isr / task cycles. 0: compile out all accounting
+#endif
+#if PPS_TIMER == 1
+#define TELEM_TCNT			TCNT1			//the 1pps counter sampled at entry / exit: ctc, wraps at OCR1A
+#else
+#define TELEM_TCNT			TCNT0			//free running counter sampled at entry / exit - must not be cleared by hardware
+#endif
+#define TELEM_CPT			PS_TMR			//cpu cycles per TELEM_TCNT tick: the 1pps timer's prescaler
+#define TELEM_TQ			(!MCU_MINI)		//1: count late edges / overruns / pending isrs. 0: compile out - no ram for it in MCU_MINI builds
+#define TELEM_DISC			((REF_SRC != REF_NONE) && !MCU_MINI)	//1: the snapshot carries the discipline loop's state
+#define TELEM_LATE_CYC		64				//an edge is late if serviced more than this many cycles after its compare match (> isr entry + prologue)
+//end hardware configuration
+
+#define TELEM_LATE			((TELEM_LATE_CYC >= TELEM_CPT) ? TELEM_LATE_CYC / TELEM_CPT : 1)	//the same in ticks, at least one
+
+//accounting slots
+#define TELEM_TMR0OVF		0				//ISR(TIMER0_OVF_vect)
+#define TELEM_TMR0A			1				//ISR(TIMER0_COMPA_vect)
+#define TELEM_TMR0B			2				//ISR(TIMER0_COMPB_vect)
+#define TELEM_TMR1OVF		3				//ISR(TIMER1_OVF_vect)
+#define TELEM_TMR1A			4				//ISR(TIMER1_COMPA_vect)
+#define TELEM_TMR1B			5				//ISR(TIMER1_COMPB_vect)
+#define TELEM_TMR1IC		6				//ISR(TIMER1_CAPT_vect), 16-bit timer1 only
+#define TELEM_REF			7				//reference input isr (pin change / analog comparator)
+#define TELEM_TASK			8				//main loop: the 1pps poll (PPS_POLL)
+#define TELEM_TLM			9				//main loop: telem_poll()
+#define TELEM_DSC			10				//main loop: pps_disc(), the discipline loop
+#define TELEM_SLOTS			11
+
+//slots kept: the others compile out and take no ram
+#if MCU_MINI
+#if REF_SRC != REF_NONE
+#define TELEM_MASK			((1<<TELEM_TMR0A) | (1<<TELEM_DSC))		//the 1pps isr and the discipline loop
+#else
+#define TELEM_MASK			((1<<TELEM_TMR0A) | (1<<TELEM_TASK))	//the 1pps isr and the main loop's 1pps poll
+#endif
+#else
+#define TELEM_MASK			((1<<TELEM_SLOTS) - 1)					//all
+#endif
+
+//kept slots are packed: the arrays below have TELEM_N entries, slot s is at [TELEM_IDX(s)]
+#define _TELEM_B(m, i)		(((m) >> (i)) & 1)
+#define _TELEM_CNT(m)		(_TELEM_B(m, 0) + _TELEM_B(m, 1) + _TELEM_B(m, 2) + _TELEM_B(m, 3) + \
+							 _TELEM_B(m, 4) + _TELEM_B(m, 5) + _TELEM_B(m, 6) + _TELEM_B(m, 7) + \
+							 _TELEM_B(m, 8) + _TELEM_B(m, 9) + _TELEM_B(m, 10) + _TELEM_B(m, 11) + \
+							 _TELEM_B(m, 12) + _TELEM_B(m, 13) + _TELEM_B(m, 14) + _TELEM_B(m, 15))	//bits set in m
+#define TELEM_N				_TELEM_CNT(TELEM_MASK)								//number of kept slots
+#define TELEM_ON(slot)		_TELEM_B(TELEM_MASK, slot)							//1 if slot is kept
+#define TELEM_IDX(slot)		_TELEM_CNT(TELEM_MASK & ((1u << (slot)) - 1))		//array index of a kept slot
+
+//telemetry snapshot
+//all times in TELEM_TCNT ticks: multiply by TELEM_CPT for cpu cycles
+//isr times exclude the compiler generated prologue / epilogue and the 4+4 cycle interrupt entry / reti
+//task times include any isr that preempted the task
+typedef struct {
+	uint32_t busy[TELEM_N];					//ticks spent in each slot during the last full second
+	uint32_t peak[TELEM_N];					//largest per-second busy[] since reset
+	uint16_t runs[TELEM_N];					//invocations during the last full second. the main loop slots stop at 65535
+	uint8_t  max[TELEM_N];					//longest single invocation since reset, held at 255
+	uint16_t secs;							//full seconds accounted since reset
+#if TELEM_DISC
+	DISC_TypeDef disc;						//discipline loop, as of the end of the last full second
+#endif
+#if TELEM_TQ
+	//timing quality, counted since the last telem_clr(). wrap around at 65536
+	uint16_t late[TELEM_N];					//compare isrs serviced more than TELEM_LATE ticks after the match
+	uint16_t ovr[TELEM_N];					//next compare point already behind the counter when loaded - a match was lost
+	uint16_t pend[TELEM_N];					//match already pending again at isr exit - the one-deep hardware flag is full
+#endif
+} TELEM_TypeDef;
+
+//accumulators - owned by the entry / exit macros below
+extern volatile uint32_t _telem_acc[TELEM_N];
+extern volatile uint16_t _telem_run[TELEM_N];
+extern volatile uint8_t _telem_max[TELEM_N];
+extern volatile uint8_t _telem_sec;
+#if TELEM_TQ
+extern volatile uint16_t _telem_late[TELEM_N];
+extern volatile uint16_t _telem_ovr[TELEM_N];
+extern volatile uint16_t _telem_pend[TELEM_N];
+#endif
+
+#if TELEM_CPU
+//bracket the body of an isr / task. each slot has its own start stamp: brackets can follow one another in a scope
+//slots left out of TELEM_MASK fold away at compile time
+//an invocation is timed modulo the counter's wrap: 256 ticks under timer0, the ctc period under timer1
+#if PPS_TIMER == 1
+#define TELEM_ENTER(slot)	uint16_t _telem_t0_##slot = TELEM_ON(slot) ? _telem_tcnt() : 0
+#define TELEM_EXIT(slot)	do {if (TELEM_ON(slot)) _telem_add(TELEM_IDX(slot), _telem_dt(_telem_t0_##slot));} while (0)
+#else
+#define TELEM_ENTER(slot)	uint8_t _telem_t0_##slot = TELEM_ON(slot) ? TELEM_TCNT : 0
+#define TELEM_EXIT(slot)	do {if (TELEM_ON(slot)) _telem_add(TELEM_IDX(slot), (uint8_t) (TELEM_TCNT - _telem_t0_##slot));} while (0)
+#endif
+#else
+#define TELEM_ENTER(slot)
+#define TELEM_EXIT(slot)
+#endif
+
+#if TELEM_TQ
+//call with the matched compare value, before it is advanced
+#define TELEM_LATE_CHK(slot, tcnt, ocr)	do {if (TELEM_ON(slot) && ((uint8_t) ((tcnt) - (ocr)) > TELEM_LATE)) _telem_late[TELEM_IDX(slot)] += 1;} while (0)
+//call with the ticks elapsed since the match, for timers that do not wrap at 8 bits
+#define TELEM_LATE_CHKN(slot, ticks)	do {if (TELEM_ON(slot) && ((ticks) > TELEM_LATE)) _telem_late[TELEM_IDX(slot)] += 1;} while (0)
+//call with the ticks elapsed since the match and the increment, before the compare value is advanced:
+//the next point is behind the counter once a whole increment has elapsed
+#define TELEM_OVR_CHK(slot, ticks, inc)	do {if (TELEM_ON(slot) && ((ticks) >= (inc))) _telem_ovr[TELEM_IDX(slot)] += 1;} while (0)
+//call with the channel's interrupt flag, at the end of the isr
+#define TELEM_PEND_CHK(slot, flag)		do {if (TELEM_ON(slot) && (flag)) _telem_pend[TELEM_IDX(slot)] += 1;} while (0)
+#else
+#define TELEM_LATE_CHK(slot, tcnt, ocr)
+#define TELEM_LATE_CHKN(slot, ticks)
+#define TELEM_OVR_CHK(slot, ticks, inc)
+#define TELEM_PEND_CHK(slot, flag)
+#endif
+
+#if PPS_TIMER == 1
+//TCNT1, atomic: a 16-bit read from the main loop must not share the TEMP register with an isr's
+static inline uint16_t _telem_tcnt(void) {
+	uint8_t sreg = SREG;
+	uint16_t t;
+
+	di();
+	t = TCNT1;
+	SREG = sreg;							//restore interrupt state
+	return t;
+}
+
+//ticks since t0, across a ctc wrap: the counter ran OCR1A + 1 ticks a period
+static inline uint16_t _telem_dt(uint16_t t0) {
+	uint16_t t = _telem_tcnt();
+
+	return (t >= t0) ? t - t0 : t + OCR1A + 1 - t0;
+}
+#endif
+
+//accumulate one invocation. inlined to keep the isr free of calls
+static inline void _telem_add(uint8_t slot, uint16_t dt) {
+	_telem_acc[slot] += dt;					//total for this second
+	if ((slot < TELEM_IDX(TELEM_TASK)) || (_telem_run[slot] != 0xFFFF)) _telem_run[slot] += 1;	//invocations for this second. an idle main loop can pass 65535: held there
+	if (dt > _telem_max[slot]) _telem_max[slot] = (dt > 0xFF) ? 0xFF : dt;	//longest invocation
+}
+
+//mark the end of a second. call from the 1pps isr, right after the edge
+#define telem_sec()			do {_telem_sec = 1;} while (0)
+
+//reset telemetry
+void telem_init(void);
+
+//latch the last second's totals. call from the main loop
+//the latch runs with interrupts disabled right after the 1pps edge, well clear of the next edge
+void telem_poll(void);
+
+//copy the last latched snapshot. slot s is at [TELEM_IDX(s)]
+void telem_read(TELEM_TypeDef *dst);
+
+//clear the timing quality counters
+void telem_clr(void);
+
+#endif
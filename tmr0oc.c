@@ -1,4 +1,5 @@
 #include "tmr0oc.h"							//we use tmr0
+#include "telem.h"							//we account isr cycles
 
 //hardware configuration
 //end hardware configuration
@@ -7,46 +8,81 @@
 
 //global variables
 
+#if MCU_MINI
+//handlers named at build time - no pointers, no empty handler
+#define TMR0_OVF_CALL()		TMR0_OVF_HOOK()
+#define TMR0A_CALL()		TMR0A_HOOK()
+#define TMR0B_CALL()		TMR0B_HOOK()
+#else
 //empty handler
 static void /*_tmr0_*/empty_handler(void) {
 	//default tmr handler
 }
 
-//uses roman black's zero cumulative error approach
 static void (* /*_tmr0*/_isrptr_tov)(void)=empty_handler;				//tmr0_ptr pointing to empty_handler by default
 static void (* /*_tmr0*/_isrptr_oca)(void)=empty_handler;				//tmr0_ptr pointing to empty_handler by default
 static void (* /*_tmr0*/_isrptr_ocb)(void)=empty_handler;				//tmr0_ptr pointing to empty_handler by default
+#define TMR0_OVF_CALL()		_isrptr_tov()
+#define TMR0A_CALL()		_isrptr_oca()
+#define TMR0B_CALL()		_isrptr_ocb()
+#endif
+
+//uses roman black's zero cumulative error approach
 static uint8_t _oca_inc=0xff;
 static uint8_t _ocb_inc=0xff;
+#if MCU_MINI
+RAM_CHK(_tmr0_ram_chk, sizeof(_oca_inc) + sizeof(_ocb_inc), MINI_RAM_DRV);
+#endif
 
+#if !MCU_MINI || defined(TMR0_OVF_HOOK)		//no hook, no isr
 //tmr0 isr
 ISR(TIMER0_OVF_vect) {
-		/*_tmr0*/_isrptr_tov();					//execute the handler
+	TELEM_ENTER(TELEM_TMR0OVF);					//start accounting
+		TMR0_OVF_CALL();						//execute the handler
+	TELEM_EXIT(TELEM_TMR0OVF);					//end accounting
 }
+#endif
 
+#if !MCU_MINI || defined(TMR0A_HOOK)
 //tmr0 compare match a
 ISR(TIMER0_COMPA_vect) {
+	TELEM_ENTER(TELEM_TMR0A);					//start accounting
+	TELEM_LATE_CHK(TELEM_TMR0A, TCNT0, OCR0A);	//serviced too long after the match?
+	TELEM_OVR_CHK(TELEM_TMR0A, (uint8_t) (TCNT0 - OCR0A), _oca_inc);	//next match already passed?
 	OCR0A += _oca_inc;							//advance tot he next match point
-	/*_tmr0*/_isrptr_oca();					//execute the handler
+	TMR0A_CALL();								//execute the handler
+	TELEM_PEND_CHK(TELEM_TMR0A, TMR0_TIFR & (1<<OCF0A));	//next match already pending?
+	TELEM_EXIT(TELEM_TMR0A);					//end accounting
 }
+#endif
 
+#if !MCU_MINI || defined(TMR0B_HOOK)
 //tmr0 compare match b
 ISR(TIMER0_COMPB_vect) {
+	TELEM_ENTER(TELEM_TMR0B);					//start accounting
+	TELEM_LATE_CHK(TELEM_TMR0B, TCNT0, OCR0B);	//serviced too long after the match?
+	TELEM_OVR_CHK(TELEM_TMR0B, (uint8_t) (TCNT0 - OCR0B), _ocb_inc);	//next match already passed?
 	OCR0B += _ocb_inc;							//advance to the next match point
-	/*_tmr0*/_isrptr_ocb();					//execute the handler
+	TMR0B_CALL();								//execute the handler
+	TELEM_PEND_CHK(TELEM_TMR0B, TMR0_TIFR & (1<<OCF0B));	//next match already pending?
+	TELEM_EXIT(TELEM_TMR0B);					//end accounting
 }
+#endif
 
 //reset the tmr
 void tmr0_init(unsigned char ps) {
+#if !MCU_MINI
 	//initialize the handler
 	_isrptr_tov = _isrptr_oca = _isrptr_ocb = empty_handler;
+#endif
 	_oca_inc=_ocb_inc=0xff;
 
 	//initialize the timer
+	PRR &=~(1<<PRTIM0);						//power up tmr0 - mcu_init() gates it
 	TCCR0B =	TCCR0B & (~TMR0_PSMASK);				//turn off tmr0
 	TCNT0 = 0;								//reset the counter
-	TIFR |= (1<<TOV0) | (1<<OCF0A) | (1<<OCF0B);						//clear by writing 1 to it
-	TIMSK = (TIMSK & ~((1<<TOIE0) | (1<<OCIE0A) | (1<<OCIE0B))) |		//tmr overflow interrupt: disabled
+	TMR0_TIFR |= (1<<TOV0) | (1<<OCF0A) | (1<<OCF0B);						//clear by writing 1 to it
+	TMR0_TIMSK = (TMR0_TIMSK & ~((1<<TOIE0) | (1<<OCIE0A) | (1<<OCIE0B))) |		//tmr overflow interrupt: disabled
 			(0<<TOIE0) | (0<<OCIE0A) | (0<<OCIE0B);
 				;
 	TCCR0B |=	(ps & TMR0_PSMASK)			//prescaler = 1:1, per the header file
@@ -57,9 +93,11 @@ void tmr0_init(unsigned char ps) {
 //for the overflow isr
 void tmr0_act(void (*isr_ptr)(void)) {
 
+#if !MCU_MINI
 	_isrptr_tov=isr_ptr;					//reassign tmr0 isr ptr
-	TIFR |= (1<<TOV0) | (0<<OCF0A) | (0<<OCF0B);						//clear by writing 1 to it
-	TIMSK |= (1<<TOIE0) | (0<<OCIE0A) | (0<<OCIE0B);						//tmr overflow interrupt: enabled
+#endif
+	TMR0_TIFR |= (1<<TOV0) | (0<<OCF0A) | (0<<OCF0B);						//clear by writing 1 to it
+	TMR0_TIMSK |= (1<<TOIE0) | (0<<OCIE0A) | (0<<OCIE0B);						//tmr overflow interrupt: enabled
 }
 
 //set up the period for cha
@@ -68,21 +106,59 @@ void tmr0a_setpr(uint8_t pr) {
 	OCR0A = TCNT0 + _oca_inc;				//load the next compare point
 }
 
+//shift the next cha match by adj ticks, from the cha handler
+//all later matches follow it: a permanent phase shift. keep TMR_TOP + adj within 255, and ahead of the counter (PPS_ADJMIN)
+void tmr0a_adj(int16_t adj) {
+	OCR0A += (uint8_t) adj;					//already advanced by the isr
+}
+
 //load user isr for cha
 void tmr0a_act(void (*isr_ptr)(void)) {
+#if !MCU_MINI
+	_isrptr_oca=isr_ptr;					//reassign tmr0 isr ptr
+#endif
+	TMR0_TIFR |= (0<<TOV0) | (1<<OCF0A) | (0<<OCF0B);						//clear by writing 1 to it
+	TMR0_TIMSK |= (0<<TOIE0) | (1<<OCIE0A) | (0<<OCIE0B);						//tmr overflow interrupt: enabled
+}
+
+//load user handler for cha, polled: the interrupt stays off and tmr0a_poll() runs it
+void tmr0a_poll_act(void (*isr_ptr)(void)) {
+#if !MCU_MINI
 	_isrptr_oca=isr_ptr;					//reassign tmr0 isr ptr
-	TIFR |= (0<<TOV0) | (1<<OCF0A) | (0<<OCF0B);						//clear by writing 1 to it
-	TIMSK |= (0<<TOIE0) | (1<<OCIE0A) | (0<<OCIE0B);						//tmr overflow interrupt: enabled
+#endif
+	TMR0_TIFR = (1<<OCF0A);					//clear by writing 1 to it
+	TMR0_TIMSK &=~(1<<OCIE0A);				//cha interrupt: disabled
+}
+
+//run the cha handler if its match has come - the isr's work, from the main loop
+//the handler runs as late as the loop polls: that delay is its latency
+uint8_t tmr0a_poll(void) {
+	if (!(TMR0_TIFR & (1<<OCF0A))) return 0;
+	TMR0_TIFR = (1<<OCF0A);					//clear only this flag
+	OCR0A += _oca_inc;						//advance to the next match point
+	TMR0A_CALL();							//execute the handler
+	return 1;
 }
+
 //set up the period for chb
 void tmr0b_setpr(uint8_t pr) {
 	_ocb_inc = pr;							//save the period value
 	OCR0B = TCNT0 + _ocb_inc;				//load the next compare point
 }
 
-//load user isr for cha
+//drive the OC0B pin from the next cha match: TMR0_OCSET / TMR0_OCCLR, or TMR0_OCOFF to hand it back to the port
+//compare b is moved onto cha's next match point, so the pin changes on that timer tick whatever the isr latency
+//call from the cha handler, after the isr has advanced OCR0A
+void tmr0b_ocfollow(uint8_t com) {
+	OCR0B = OCR0A;
+	TCCR0A = (TCCR0A & ~((1<<COM0B1) | (1<<COM0B0))) | ((com & 3) << COM0B0);
+}
+
+//load user isr for chb
 void tmr0b_act(void (*isr_ptr)(void)) {
+#if !MCU_MINI
 	_isrptr_ocb=isr_ptr;					//reassign tmr0 isr ptr
-	TIFR |= (0<<TOV0) | (0<<OCF0A) | (1<<OCF0B);						//clear by writing 1 to it
-	TIMSK |= (0<<TOIE0) | (0<<OCIE0A) | (1<<OCIE0B);						//tmr overflow interrupt: enabled
+#endif
+	TMR0_TIFR |= (0<<TOV0) | (0<<OCF0A) | (1<<OCF0B);						//clear by writing 1 to it
+	TMR0_TIMSK |= (0<<TOIE0) | (0<<OCIE0A) | (1<<OCIE0B);						//tmr overflow interrupt: enabled
 }
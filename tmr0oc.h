@@ -6,9 +6,30 @@
 #include <avr/interrupt.h>					//we use interrupt
 
 //hardware configuration
+//MCU_MINI: handlers named at build time. an isr calls its hook directly, tmr0x_act() only enables the interrupt
+//leave a hook undefined and its isr is not built at all
+#if MCU_MINI
+//#define TMR0_OVF_HOOK		user_tov			//overflow handler
+#define TMR0A_HOOK			pps_out				//cha handler
+//#define TMR0B_HOOK		user_ocb			//chb handler
+#endif
 //end hardware configuration
 
 //global defines
+//register / vector names differ across parts
+#if defined(TIMSK0)
+#define TMR0_TIMSK			TIMSK0		//atmega328p, attiny24/44/84
+#define TMR0_TIFR			TIFR0
+#else
+#define TMR0_TIMSK			TIMSK		//attiny25/45/85
+#define TMR0_TIFR			TIFR
+#endif
+#if !defined(TIMER0_COMPA_vect) && defined(TIM0_COMPA_vect)		//attiny24/44/84
+#define TIMER0_OVF_vect		TIM0_OVF_vect
+#define TIMER0_COMPA_vect	TIM0_COMPA_vect
+#define TIMER0_COMPB_vect	TIM0_COMPB_vect
+#endif
+
 //prescaler settings
 #define TMR0_NOCLK			0x00		//cs210=no clock selected
 #define TMR0_PS1x			0x01		//clk/1
@@ -19,6 +40,13 @@
 #define TMR0_EXTN			0x06		//external clock on Tn pin, negative transistion
 #define TMR0_EXTP			0x07		//external clock on Tn pin, positive transistion
 #define TMR0_PSMASK			0x07
+//compare output b modes, for tmr0b_ocfollow()
+#define TMR0_OCOFF			0x00		//disconnected: the port drives the pin
+#define TMR0_OCCLR			0x02		//clear on match
+#define TMR0_OCSET			0x03		//set on match
+
+//log2 of the prescaler divider, for shift-based division: x / PS = x >> TMR0_PSSH(ps)
+#define TMR0_PSSH(ps)		(((ps) == TMR0_PS8x) ? 3 : ((ps) == TMR0_PS64x) ? 6 : ((ps) == TMR0_PS256x) ? 8 : ((ps) == TMR0_PS1024x) ? 10 : 0)
 
 //rtc period settings
 //tmr period settings
@@ -42,6 +70,17 @@
 //#define TMR_10000ms			(TMR_ms * 10000)			//10000ms
 
 
+//build-time handlers
+#if defined(TMR0_OVF_HOOK)
+void TMR0_OVF_HOOK(void);
+#endif
+#if defined(TMR0A_HOOK)
+void TMR0A_HOOK(void);
+#endif
+#if defined(TMR0B_HOOK)
+void TMR0B_HOOK(void);
+#endif
+
 //reset the tmr
 void tmr0_init(unsigned char ps);
 
@@ -51,7 +90,11 @@ void tmr0_act(void (*isr_ptr)(void));
 //for output match ch a/b
 void tmr0a_setpr(uint8_t pr);
 void tmr0a_act(void (*isr_ptr)(void));
+void tmr0a_adj(int16_t adj);						//shift the next cha match by adj ticks - from the cha handler
+void tmr0a_poll_act(void (*isr_ptr)(void));		//cha handler without the interrupt: run by tmr0a_poll()
+uint8_t tmr0a_poll(void);							//from the main loop: run the cha handler if its match has come. 1 if it ran
 void tmr0b_setpr(uint8_t pr);
 void tmr0b_act(void (*isr_ptr)(void));
+void tmr0b_ocfollow(uint8_t com);					//OC0B pin: TMR0_OCSET / TMR0_OCCLR on the next cha match
 
 #endif // TMR0_H_INCLUDED
@@ -1,4 +1,5 @@
 #include "tmr1oc.h"					//we use timer1 output compare
+#include "telem.h"					//we account isr cycles
 
 //empty handler
 static void /*_tmr1_*/empty_handler(void) {
@@ -8,29 +9,154 @@ static void /*_tmr1_*/empty_handler(void) {
 static void (* _isrptr_tov)(void)=empty_handler;	//tmr1_ptr pointing to empty_handler by default
 static void (* _isrptr_oca)(void)=empty_handler;	//tmr1_ptr pointing to empty_handler by default
 static void (* _isrptr_ocb)(void)=empty_handler;	//tmr1_ptr pointing to empty_handler by default
+#if TMR1_16BIT
+static void (* _isrptr_icp)(void)=empty_handler;	//tmr1_ptr pointing to empty_handler by default
+static volatile uint16_t _icr;			//last input capture
+uint16_t _oca_inc;						//oc1a period - ctc top + 1
+uint16_t _ocb_inc;						//oc1b offset into the oc1a period
+#else
 uint8_t _oca_inc;						//compare point for oc1a increment / period
 uint8_t _ocb_inc;						//compare point for oc1b increment / period
+#endif
 
 //timer overflow
 ISR(TIMER1_OVF_vect) {
+	TELEM_ENTER(TELEM_TMR1OVF);		//start accounting
 	//clear the flag - done automatically
 	//OCR1A += _oca_inc;					//advance to the next compare point
 	_isrptr_tov();					//run the user handler
+	TELEM_EXIT(TELEM_TMR1OVF);		//end accounting
 }
 
+#if TMR1_16BIT
 //output compare a isr
+//ctc: the hardware restarts the period at the match - nothing to reload, no cumulative error
 ISR(TIMER1_COMPA_vect) {
+	TELEM_ENTER(TELEM_TMR1A);		//start accounting
 	//clear the flag - done automatically
+	TELEM_LATE_CHKN(TELEM_TMR1A, TCNT1);	//counter restarted at the match: TCNT1 = ticks since
+	_isrptr_oca();					//run the user handler
+	TELEM_PEND_CHK(TELEM_TMR1A, TMR1_TIFR & (1<<OCF1A));	//next match already pending?
+	TELEM_EXIT(TELEM_TMR1A);		//end accounting
+}
+
+//ticks since the channel b match. ctc: the counter may have wrapped at OCR1A since
+static inline uint16_t _ocb_since(void) {
+	uint16_t t = TCNT1;
+
+	return (t >= OCR1B) ? t - OCR1B : t + OCR1A + 1 - OCR1B;
+}
+
+//output compare b isr
+//fires once per oc1a period, _ocb_inc ticks into it
+ISR(TIMER1_COMPB_vect) {
+	TELEM_ENTER(TELEM_TMR1B);		//start accounting
+	//clear the flag - done automatically
+	TELEM_LATE_CHKN(TELEM_TMR1B, _ocb_since());	//serviced too long after the match?
+	_isrptr_ocb();					//run the user handler
+	TELEM_PEND_CHK(TELEM_TMR1B, TMR1_TIFR & (1<<OCF1B));	//next match already pending?
+	TELEM_EXIT(TELEM_TMR1B);		//end accounting
+}
+
+//input capture isr
+ISR(TIMER1_CAPT_vect) {
+	TELEM_ENTER(TELEM_TMR1IC);		//start accounting
+	//clear the flag - done automatically
+	_icr = ICR1;					//latch it before the next edge overwrites ICR1
+	_isrptr_icp();					//run the user handler
+	TELEM_EXIT(TELEM_TMR1IC);		//end accounting
+}
+
+//reset the tmr
+//ctc mode: top = OCR1A, 0xffff until tmr1a_setpr()
+void tmr1_init(uint8_t prescaler) {
+	//reset user isr handlers and default output compare increments
+	_isrptr_tov = _isrptr_oca = _isrptr_ocb = _isrptr_icp = empty_handler;
+	_oca_inc = _ocb_inc = 0xffff;					//default values
+
+	PRR &=~(1<<PRTIM1);						//power up tmr1 - mcu_init() gates it
+	TCCR1B =	0x00;						//turn off tmr1
+	TCCR1A =	(0<<COM1A1) | (0<<COM1A0) |	//output compare a pins normal operation
+				(0<<COM1B1) | (0<<COM1B0) |	//output compare b pins normal operation
+				(0<<WGM11) | (0<<WGM10)		//wgm13..0 = 0b0100 -> ctc, top = OCR1A
+				;
+	TCNT1 = 0;								//reset the timer / counter
+	OCR1A = _oca_inc;						//full 16-bit period until set
+	OCR1B = _ocb_inc;
+	TMR1_TIFR |= (1<<ICF1) | (1<<OCF1A) | (1<<OCF1B) | (1<<TOV1);		//clear the flag by writing '1' to it
+	TMR1_TIMSK &=~((1<<ICIE1) |				//input capture isr: disabled
+				(1<<OCIE1B) |				//output compare isr for ch b: disabled
+				(1<<OCIE1A) |				//output compare isr for ch a: disabled
+				(1<<TOIE1));				//tmr overflow interrupt: disabled
+	TCCR1B =	(0<<ICNC1) |				//input capture noise canceler: off - it adds 4 cycles of delay
+				(1<<ICES1) |				//input capture on the rising edge
+				(0<<WGM13) | (1<<WGM12) |	//wgm13..0 = 0b0100 -> ctc, top = OCR1A
+				(prescaler & TMR1_PSMASK)	//prescaler, per the header file
+				;
+	//now timer1 is running
+}
+
+//set the ctc period for channel a: pr ticks between matches
+void tmr1a_setpr(uint16_t pr) {
+	_oca_inc = pr;
+	OCR1A = _oca_inc - 1;					//counter runs 0..OCR1A
+}
+
+//set the offset of channel b into the channel a period
+void tmr1b_setpr(uint16_t pr) {
+	_ocb_inc = pr;
+	OCR1B = _ocb_inc;						//matches once per period
+}
+
+//stretch the current ctc period by adj ticks
+//a top moved behind the counter is missed until 0xffff: keep _oca_inc + adj ahead of it (PPS_ADJMIN)
+void tmr1a_adj(int16_t adj) {
+	OCR1A = _oca_inc - 1 + adj;				//ctc: takes effect for the period under way
+}
+
+//select the input capture edge
+void tmr1ic_edge(uint8_t edge) {
+	if (edge == TMR1_ICRISE) TCCR1B |= (1<<ICES1);
+	else TCCR1B &=~(1<<ICES1);
+	TMR1_TIFR |= (1<<ICF1);					//changing ICES1 may set the flag
+}
+
+//install user handler for input capture
+void tmr1ic_act(void (*isr_ptr)(void)) {
+	_isrptr_icp=isr_ptr;					//reassign tmr1 isr ptr
+	TMR1_TIFR |= (1<<ICF1);					//clear the flag by writing '1' to it
+	TMR1_TIMSK |= (1<<ICIE1);				//input capture interrupt: enabled
+}
+
+//last captured value
+uint16_t tmr1ic_get(void) {
+	return _icr;
+}
+#else
+//output compare a isr
+ISR(TIMER1_COMPA_vect) {
+	TELEM_ENTER(TELEM_TMR1A);		//start accounting
+	//clear the flag - done automatically
+	TELEM_LATE_CHK(TELEM_TMR1A, TCNT1, OCR1A);	//serviced too long after the match?
+	TELEM_OVR_CHK(TELEM_TMR1A, (uint8_t) (TCNT1 - OCR1A), _oca_inc);	//next match already passed?
 	OCR1A += _oca_inc;					//advance to the next compare point
 	_isrptr_oca();					//run the user handler
+	TELEM_PEND_CHK(TELEM_TMR1A, TMR1_TIFR & (1<<OCF1A));	//next match already pending?
+	TELEM_EXIT(TELEM_TMR1A);		//end accounting
 }
 
 //output compare b isr
 ISR(TIMER1_COMPB_vect) {
+	TELEM_ENTER(TELEM_TMR1B);		//start accounting
 	//clear the flag - done automatically
+	TELEM_LATE_CHK(TELEM_TMR1B, TCNT1, OCR1B);	//serviced too long after the match?
+	TELEM_OVR_CHK(TELEM_TMR1B, (uint8_t) (TCNT1 - OCR1B), _ocb_inc);	//next match already passed?
 	OCR1B += _ocb_inc;					//advance to the next compare point
 	_isrptr_ocb();					//run the user handler
+	TELEM_PEND_CHK(TELEM_TMR1B, TMR1_TIFR & (1<<OCF1B));	//next match already pending?
+	TELEM_EXIT(TELEM_TMR1B);		//end accounting
 }
+
 //reset the tmr
 //default: normal mode (16-bit top at 0xffff)
 void tmr1_init(uint8_t prescaler) {
@@ -38,6 +164,7 @@ void tmr1_init(uint8_t prescaler) {
 	_isrptr_tov = _isrptr_oca = _isrptr_ocb = empty_handler;
 	_oca_inc = _ocb_inc = 0xff;						//default values
 
+	PRR &=~(1<<PRTIM1);						//power up tmr1 - mcu_init() gates it
 	//TCCR1  =	TCCR1 & (~TMR1_PSMASK);			//turn off tmr1
 	///*_tmr1*/_isr_ptr=/*_tmr1_*/empty_handler;			//reset isr ptr
 	TCCR1  =	(0<<COM1A1) | (0<<COM1A0) |	//output compare a pins normal operation
@@ -53,8 +180,8 @@ void tmr1_init(uint8_t prescaler) {
 	//			;
 	//OCR1A = period-1;
 	TCNT1 = 0;								//reset the timer / counter
-	TIFR |= (1<<OCF1A) | (1<<OCF1B) | (1<<TOV1);		//clear the flag by writing '1' to it
-	TIMSK =		//(0<<TICIE1) |				//input capture isr: disabled
+	TMR1_TIFR |= (1<<OCF1A) | (1<<OCF1B) | (1<<TOV1);		//clear the flag by writing '1' to it
+	TMR1_TIMSK =		//(0<<TICIE1) |				//input capture isr: disabled
 				//(0<<OCIE1C) |				//output compare isr for ch a: disabled
 				(0<<OCIE1B) |				//output compare isr for ch b: disabled
 				(0<<OCIE1A) |				//output compare isr for ch c: disabled
@@ -70,8 +197,8 @@ void tmr1_init(uint8_t prescaler) {
 //need to pay attention to the mode bits (wgm13..0) and dc value
 void tmr1a_setpr(uint16_t pr) {
 	///*_tmr1*/_isr_ptr=isr_ptr;					//reassign tmr1 isr ptr
-	//TIFR |= (1<<OCF1A);						//clear the flag by writing '1' to it
-	//TIMSK |=	(1<<OCIE1A)					//tmr overflow interrupt: enabled
+	//TMR1_TIFR |= (1<<OCF1A);						//clear the flag by writing '1' to it
+	//TMR1_TIMSK |=	(1<<OCIE1A)					//tmr overflow interrupt: enabled
 	//			;
 
 	//IO_OUT(PWM1A_DDR, PWM1A);				//oc1a as output
@@ -84,8 +211,8 @@ void tmr1a_setpr(uint16_t pr) {
 //need to pay attention to the mode bits (wgm13..0) and dc value
 void tmr1b_setpr(uint16_t pr) {
 	///*_tmr1*/_isr_ptr=isr_ptr;					//reassign tmr1 isr ptr
-	//TIFR |= (1<<OCF1A);						//clear the flag by writing '1' to it
-	//TIMSK |=	(1<<OCIE1A)					//tmr overflow interrupt: enabled
+	//TMR1_TIFR |= (1<<OCF1A);						//clear the flag by writing '1' to it
+	//TMR1_TIMSK |=	(1<<OCIE1A)					//tmr overflow interrupt: enabled
 	//			;
 
 	//IO_OUT(PWM1B_DDR, PWM1B);				//oc1b as output
@@ -94,11 +221,17 @@ void tmr1b_setpr(uint16_t pr) {
 	OCR1B = TCNT1 + _ocb_inc;							//set dc
 }
 
+//shift the next cha match by adj ticks
+void tmr1a_adj(int16_t adj) {
+	OCR1A += (uint8_t) adj;					//already advanced by the isr
+}
+#endif
+
 //install user handler for timer1 overflow
 void tmr1_act(void (*isr_ptr)(void)) {
 	_isrptr_tov=isr_ptr;					//reassign tmr1 isr ptr
-	TIFR |= (0<<OCF1A) | (0<<OCF1B) | (1<<TOV1);		//clear the flag by writing '1' to it
-	TIMSK |=	//(0<<TICIE1) |				//input capture isr: disabled
+	TMR1_TIFR |= (0<<OCF1A) | (0<<OCF1B) | (1<<TOV1);		//clear the flag by writing '1' to it
+	TMR1_TIMSK |=	//(0<<TICIE1) |				//input capture isr: disabled
 				//(0<<OCIE1C) |				//output compare isr for ch a: disabled
 				(0<<OCIE1B) |				//output compare isr for ch b: disabled
 				(0<<OCIE1A) |				//output compare isr for ch c: disabled
@@ -110,8 +243,8 @@ void tmr1_act(void (*isr_ptr)(void)) {
 //install user handler
 void tmr1a_act(void (*isr_ptr)(void)) {
 	_isrptr_oca=isr_ptr;					//reassign tmr1 isr ptr
-	TIFR |= (1<<OCF1A) | (0<<OCF1B) | (0<<TOV1);		//clear the flag by writing '1' to it
-	TIMSK |=	//(0<<TICIE1) |				//input capture isr: disabled
+	TMR1_TIFR |= (1<<OCF1A) | (0<<OCF1B) | (0<<TOV1);		//clear the flag by writing '1' to it
+	TMR1_TIMSK |=	//(0<<TICIE1) |				//input capture isr: disabled
 				//(0<<OCIE1C) |				//output compare isr for ch a: disabled
 				(0<<OCIE1B) |				//output compare isr for ch b: disabled
 				(1<<OCIE1A) |				//output compare isr for ch c: disabled
@@ -123,8 +256,8 @@ void tmr1a_act(void (*isr_ptr)(void)) {
 //install user handler
 void tmr1b_act(void (*isr_ptr)(void)) {
 	_isrptr_ocb=isr_ptr;					//reassign tmr1 isr ptr
-	TIFR |= (0<<OCF1A) | (1<<OCF1B) | (0<<TOV1);		//clear the flag by writing '1' to it
-	TIMSK |=	//(0<<TICIE1) |				//input capture isr: disabled
+	TMR1_TIFR |= (0<<OCF1A) | (1<<OCF1B) | (0<<TOV1);		//clear the flag by writing '1' to it
+	TMR1_TIMSK |=	//(0<<TICIE1) |				//input capture isr: disabled
 				//(0<<OCIE1C) |				//output compare isr for ch a: disabled
 				(1<<OCIE1B) |				//output compare isr for ch b: disabled
 				(0<<OCIE1A) |				//output compare isr for ch c: disabled
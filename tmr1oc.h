@@ -9,6 +9,46 @@
 //hardware configuration
 //end hardware configuration
 
+//timer1 flavour
+#if defined(ICR1)
+#define TMR1_16BIT			1			//16-bit timer1 with ctc and input capture: atmega328p, attiny24/44/84
+#else
+#define TMR1_16BIT			0			//8-bit timer1: attiny25/45/85
+#endif
+
+//register / vector names differ across parts
+#if defined(TIMSK1)
+#define TMR1_TIMSK			TIMSK1
+#define TMR1_TIFR			TIFR1
+#else
+#define TMR1_TIMSK			TIMSK
+#define TMR1_TIFR			TIFR
+#endif
+#if !defined(TIMER1_COMPA_vect) && defined(TIM1_COMPA_vect)		//attiny24/44/84
+#define TIMER1_OVF_vect		TIM1_OVF_vect
+#define TIMER1_COMPA_vect	TIM1_COMPA_vect
+#define TIMER1_COMPB_vect	TIM1_COMPB_vect
+#define TIMER1_CAPT_vect	TIM1_CAPT_vect
+#endif
+
+#if TMR1_16BIT
+//prescaler defines - 16-bit timer1
+#define TMR1_NOCLK			0x00		//cs12..0=no clock selected
+#define TMR1_PS1x			0x01		//clk/1
+#define TMR1_PS8x			0x02		//clk/8
+#define TMR1_PS64x			0x03		//clk/64
+#define TMR1_PS256x			0x04		//clk/256
+#define TMR1_PS1024x		0x05		//clk/1024
+#define TMR1_EXTN			0x06		//external clock on T1 pin, negative transistion
+#define TMR1_EXTP			0x07		//external clock on T1 pin, positive transistion
+#define TMR1_PSMASK			0x07
+//log2 of the prescaler divider, for shift-based division: x / PS = x >> TMR1_PSSH(ps)
+#define TMR1_PSSH(ps)		(((ps) == TMR1_PS8x) ? 3 : ((ps) == TMR1_PS64x) ? 6 : ((ps) == TMR1_PS256x) ? 8 : ((ps) == TMR1_PS1024x) ? 10 : 0)
+
+//input capture edge
+#define TMR1_ICFALL			0x00		//capture on the falling edge of ICP1
+#define TMR1_ICRISE			0x01		//capture on the rising edge of ICP1
+#else
 //prescaler defines
 #define TMR1_NOCLK			0x00		//cs210=no clock selected
 #define TMR1_PS1x			0x01		//clk/1
@@ -27,6 +67,9 @@
 #define TMR1_PS8192x		0x0e		//clk/1024
 #define TMR1_PS16384x		0x0f		//clk/1024
 #define TMR1_PSMASK			0x0f
+//log2 of the prescaler divider, for shift-based division: x / PS = x >> TMR1_PSSH(ps)
+#define TMR1_PSSH(ps)		((ps) - TMR1_PS1x)
+#endif
 
 //tmr period settings
 #define TMR_ms				(F_CPU / 1000)				//1ms period - minimum period
@@ -47,11 +90,15 @@
 //set dc for channel a
 //0b10->clear on compare match
 //need to pay attention to the mode bits (wgm13..0) and dc value
+//16-bit timer1: ctc mode, top = OCR1A. 8-bit timer1: free running, compare points advanced in the isrs
 void tmr1_init(uint8_t prescaler);
 
 //set dc for channel b
 //0b10->clear on compare match
 //need to pay attention to the mode bits (wgm13..0) and dc value
+//16-bit timer1: cha sets the ctc period (pr ticks, 1..65536 - call it before the counter passes pr) - no isr reload needed
+//               chb fires once per cha period, pr ticks into it (pr < cha period)
+//               the overflow isr only fires if the cha period is 65536
 void tmr1a_setpr(uint16_t dc);
 void tmr1b_setpr(uint16_t dc);
 
@@ -60,4 +107,16 @@ void tmr1_act(void (*isr_ptr)(void));					//user handler for timer1 overflow
 void tmr1a_act(void (*isr_ptr)(void));					//user handler for timer1 cha output compare
 void tmr1b_act(void (*isr_ptr)(void));					//user handler for timer1 chb output compare
 
+//shift timing of channel a by adj ticks, from the cha handler
+//16-bit timer1: stretches the current ctc period. call again with 0 from the next cha handler to restore it
+//8-bit timer1: shifts the next match and all later ones
+void tmr1a_adj(int16_t adj);
+
+#if TMR1_16BIT
+//input capture on ICP1 - the timer latches TCNT1 into ICR1 on the selected edge, no isr latency involved
+void tmr1ic_edge(uint8_t edge);							//TMR1_ICRISE or TMR1_ICFALL
+void tmr1ic_act(void (*isr_ptr)(void));					//user handler for timer1 input capture
+uint16_t tmr1ic_get(void);								//last captured value, for use in the user handler
+#endif
+
 #endif